@@ -2,6 +2,29 @@
 
 Example usage:
 	SuSolve mysudoku.txt
+	SuSolve -o steps mysudoku.txt > steps.txt
+	SuSolve -b puzzles.txt > solutions.txt
+	SuSolve -j 8 puzzles.txt > solutions.txt
+	SuSolve -j 8 -m fast puzzles.txt > solutions.txt
+	SuSolve -j 8 -m lanes puzzles.txt > solutions.txt
+	SuSolve -j 8 -c 2 puzzles.txt > counts.txt
+	SuSolve -j 8 -t json puzzles.txt > trace.jsonl
+	SuSolve -j 8 -R puzzles.txt > ratings.txt
+	SuSolve -j 8 -K seen.cache puzzles.txt > solutions.txt
+	SuSolve -G 1000 -S 42 -d pointing > new.txt
+	SuSolve -B > bench.json
+
+Build with:
+	make
+or with hot path counters, which are written to stderr on exit and on SIGUSR1:
+	make clean all CFLAGS="-O2 -DSUSOLVE_COUNTERS"
+make also builds SuSolve4, SuSolve16 and SuSolve25 (on libsusolve4, libsusolve16 and libsusolve25, see
+susolve.h) for 4x4, 16x16 and 25x25 grids, which take the same
+options and read values 1-9 then A onwards (A-G for 16x16), lines of 256 or 625 cells in batch mode.
+Lanes mode and binary traces are 9x9 only, the other sizes solve lanes batches as explain mode and
+write JSON traces.
+Generating is slower on the larger grids, about half a second a puzzle on 16x16 and 15 seconds on 25x25,
+where puzzles may keep a given or two more than the minimum, as uniqueness checks are given up on past a limit.
 
 Where mysudoku.txt contains something like:
 .....9.4.
@@ -14,29 +37,63 @@ Where mysudoku.txt contains something like:
 5.37.....
 .4.2.....
 
-All positions are indexed from 0 (column 0-8, row 0-8 etc).
-All values are referenced as actual values 1-9 (no 0)
-
-2 cell addressing schemes
-
-	X-Y coodrdinates
-
-	N-I
-	N is row/column/square (0-8)
-	I is cell index(0-8) within that row/column/square
-	Squares are numbered top left to bottom right, accross then down
-	Columns are left to right (same X)
-	Rows are top to bottom (same Y)
-
-	Terms
-		RCS	Row Column or Square
-		RC	Row or Column
+Batch mode (-b) reads one puzzle per line, in the same format, from a file or from stdin if the
+file is "-". Nothing is printed while solving, and for each input line one line of 81 characters
+is written with the solved grid ('.' for any cell left unsolved), or "error" if the line is not a
+valid puzzle.
+Puzzles the solving methods cannot finish are completed by a depth first search.
+
+Options
+	-o level	output for a single puzzle, "board" (default) shows the board with candidates before each
+				step and waits for enter, "steps" prints each step taken then the solved grid, and
+				"solution" prints the solved grid only, steps are only formatted if they are printed
+	-b			batch mode
+	-j N		solve a batch with N threads (0 for one per processor), implies -b, output order is kept
+	-m mode		"explain" (default) works through the solving methods in order of simplicity,
+				"fast" goes straight to an exact cover search with dancing links (Knuth's algorithm X)
+				"lanes" batches 16 puzzles at a time through singles and pointing in lockstep, one puzzle
+				per vector lane, puzzles left unsolved carry on one at a time as in explain mode
+	-c N		count solutions instead of solving, one count per line, implies -b
+				counting stops at N, so N means "N or more" and -c 2 checks for a unique solution
+				in explain mode the solving methods are applied first (they hold for every solution)
+	-t format	write a step trace in place of the usual output, "json" for JSON Lines or "binary" for fixed
+				records, each deduction with its technique, digits, houses and candidates removed, then
+				the result for each puzzle, see susolve.h for the formats (not with -c)
+	-R			rate each puzzle in place of solving it, implies -b, writes a line with the score and the
+				hardest technique needed, "5036 hidden_set", or "unsolvable", see susolve.h for the score
+				puzzles are always rated with the solving methods, whatever -m says
+	-G N		generate N puzzles, each with a unique solution and no given that could be taken away (past 9x9 see above),
+				writes a line per puzzle with the puzzle and its rating, as -R
+	-S seed		generator seed, the same seed gives the same puzzles (by default taken from the time)
+	-d method	generate only puzzles whose hardest technique is this one, sole_candidate,
+				unique_candidate, pointing, naked_set, hidden_set, fish, xy_wing, coloring, chain or search
+	-T N		with -d, give up (exit code 1) after N puzzles in a row are not the method (default 100000),
+				some are rare, and on the small grids some never happen
+	-C			cache solutions by canonical form, a puzzle equivalent to one already solved (digits relabelled,
+				bands, stacks, rows or columns within them reordered, or transposed) is answered from the
+				cache, see susolve.h, implies -b, solving only (not with -c, -t or -R), lanes mode solves as explain
+	-K file		as -C, reading the cache from file first if it is there, and writing it back after
+	-a			each solving method applies every deduction it finds in one pass, not just the first
+	-s			print the number of puzzles that needed search and the nodes searched to stderr
+	-B			benchmark, solve each file (by default the bundled puzzles/easy.txt, puzzles/hard.txt and
+				puzzles/pathological.txt) one puzzle at a time and write JSON results to stdout,
+				puzzles per second, latency percentiles and the time spent in each solving method,
+				in explain or fast mode (lanes mode needs a batch, so is not benchmarked)
+	-r N		benchmark each file N times over
 
 */
 
+	//getopt, SIGUSR1 and sysconf, whatever dialect the compiler defaults to
+	#define _POSIX_C_SOURCE	200809L
+
     #include <stdio.h>
-    #include <stdint.h>
+    #include <stdlib.h>
     #include <string.h>
+    #include <unistd.h>
+    #include <signal.h>
+    #include <time.h>
+
+    #include "susolve.h"
 
 //*******************************************************
 // Defines
@@ -45,71 +102,14 @@ All values are referenced as actual values 1-9 (no 0)
 	#define TRUE	1
 	#define	FALSE	0
 
-	#define ROW		0
-	#define COLUMN	1
-	#define SQUARE	2
-
-//	macro to get cells row/column/square n, by specefying it's index within a different column/square/row
-	#define TRANS_TYPE_N(out_type, in_type, in_n, in_i)	n_of(out_type, x_of(in_type, in_n, in_i), y_of(in_type, in_n, in_i))
-
-//	macro to get cells index within it's row/column/square by specefying it's index within a different column/square/row
-	#define TRANS_TYPE_I(out_type, in_type, in_n, in_i) i_of(out_type, x_of(in_type, in_n, in_i), y_of(in_type, in_n, in_i))
-
-	//for each cell store possible 1-9 and solved value
-	//0 indicates not possible/not solved
-	struct cell_struct
-	{
-		uint8_t	possible[10];	//index 0 not used, index 1-9 loaded with 1-9 to represent possible
-		uint8_t	certain;		//solved value
-	};
-
-	//used to avoid multi-dimensional arrays
-	struct mask_struct
-	{
-		uint8_t mask[9];
-		uint8_t count;
-	};
-
-//*******************************************************
-// Variables
-//*******************************************************
-
-	static uint8_t	cells_solved=0;
-	static struct cell_struct map[81];
-
-	static char* type_string[3] = {"row", "column", "square"};
-
 //*******************************************************
 // Prototypes
 //*******************************************************
 
-	static void 		init_map(void);
-	static void			show_map(void);
-	static void			cell_solve(uint8_t x, uint8_t y, uint8_t value);
-	static uint8_t		read_file_map(FILE *fp);
-	static uint8_t 		cell_possible_count(struct cell_struct *cell);
-	static uint8_t 		remove_from(uint8_t type, uint8_t n, uint8_t *list, uint8_t list_size, uint8_t *mask);
-	static uint8_t		count_mask(uint8_t *x_ptr);
-	static uint8_t 		population_in_rcs(uint8_t type, uint8_t n, uint8_t value, uint8_t *mask);
-	static uint8_t 		finger_step(uint8_t *thumb_ptr, uint8_t *finger_ptr, uint8_t last_index);
-	static void 		mask_or(uint8_t *target, uint8_t *source);
-
-//	Type conversion
-	static uint8_t		n_of(uint8_t type, uint8_t x, uint8_t y);
-	static uint8_t		i_of(uint8_t type, uint8_t x, uint8_t y);
-	static uint8_t		x_of(uint8_t type, uint8_t n, uint8_t i);
-	static uint8_t		y_of(uint8_t type, uint8_t n, uint8_t i);
-
-//	map addressing
-	static struct cell_struct* 	map_get(uint8_t type, uint8_t n, uint8_t cellno);
-
-//	solving methods
-	static uint8_t 		sole_candidate(void);
-	static uint8_t 		unique_candidate(void);
-	static uint8_t 		pointing(uint8_t type_a, uint8_t type_b);
-	static uint8_t 		naked_set(void);
-	static uint8_t		hidden_set(void);
-	static uint8_t 		xwing(void);
+	static int			method_id(const char *name);
+#ifdef SUSOLVE_COUNTERS
+	static void			counters_signal(int signal);
+#endif
 
 //*******************************************************
 // Functions
@@ -117,817 +117,145 @@ All values are referenced as actual values 1-9 (no 0)
 
 int main(int argc, char *argv[])
 {
-	uint8_t success = TRUE;
-
-	FILE *fp;
-
-	init_map();
-
-	if(argc > 1)
-	{
-		fp = fopen(argv[1], "r");
-		if(!fp)
-		{
-			success=FALSE;
-			printf("File not found");
-		};
-	}
-	else
-		success=FALSE;
-
-	if(success)
-	{
-		success = read_file_map(fp);
-		if(!success)
-			printf("Error in file\r\n\r\n");
-		fclose(fp);
-	};
-
-	if(success)
-	{
-		while(success && (cells_solved < 81))
-		{
-			show_map();
-			success = sole_candidate();
-			if(!success)
-				success = unique_candidate();
-			if(!success)
-				success = pointing(SQUARE, ROW);
-			if(!success)
-				success = pointing(SQUARE, COLUMN);
-			if(!success)
-				success = pointing(ROW, SQUARE);
-			if(!success)
-				success = pointing(COLUMN, SQUARE);
-			if(!success)
-				success = naked_set();
-			if(!success)
-				success = hidden_set();
-			if(!success)
-				success = xwing();
-			if(success)
-            {
-                printf("(enter to continue)\r\n");
-				getchar();
-            };
-		};
-		show_map();
-	};
-
-	return 0;
-}
-
-//*******************************************************
-// misc functions
-//*******************************************************
-
-//remove list of candidates from RCS 'n'
-//the list may contain 0's which will be ignored, and may be another cells possible[] array
-//no text is output, returns true if any candidates were removed
-//only acts on cells with non0 values in the mask[9] array
-static uint8_t remove_from(uint8_t type, uint8_t n, uint8_t *list, uint8_t list_size, uint8_t *mask)
-{
-	uint8_t i=0, list_index;
-	uint8_t success=FALSE;
-
-	while(i != 9)
+	int opt;
+	struct susolve_options options;
+
+	options.batch = FALSE;
+	options.stats = FALSE;
+	options.mode = SUSOLVE_EXPLAIN;
+	options.apply_all = FALSE;
+	options.threads = 1;
+	options.count_limit = 0;
+	options.bench = FALSE;
+	options.repeat = 1;
+	options.output = SUSOLVE_OUTPUT_BOARD;
+	options.trace = SUSOLVE_TRACE_NONE;
+	options.rate = FALSE;
+	options.generate = 0;
+	options.seed = (unsigned long long)time(NULL);
+	options.target = -1;
+	options.misses = 0;
+	options.cache = FALSE;
+	options.cache_file = NULL;
+
+#ifdef SUSOLVE_COUNTERS
+	signal(SIGUSR1, counters_signal);
+#endif
+
+	while((opt = getopt(argc, argv, "bj:sm:c:aBr:o:t:RG:S:d:T:CK:")) != -1)
 	{
-		if(mask[i])
+		if(opt == 'b')
+			options.batch=TRUE;
+		else if(opt == 's')
+			options.stats=TRUE;
+		else if(opt == 'a')
+			options.apply_all=TRUE;
+		else if(opt == 'B')
+			options.bench=TRUE;
+		else if((opt == 'G') && (atol(optarg) > 0))
+			options.generate = (unsigned long)atol(optarg);
+		else if(opt == 'S')
+			options.seed = strtoull(optarg, NULL, 0);
+		else if((opt == 'd') && (method_id(optarg) >= 0))
+			options.target = method_id(optarg);
+		else if((opt == 'T') && (atol(optarg) > 0))
+			options.misses = (unsigned long)atol(optarg);
+		else if(opt == 'C')
 		{
-			list_index=0;
-			while(list_index != list_size)
-			{
-				if(list[list_index])
-				{
-					if(map_get(type, n,i)->possible[list[list_index]])	//candidate to be removed?
-					{
-						success=TRUE;
-						map_get(type, n,i)->possible[list[list_index]]=0;
-					};
-				};
-				list_index++;
-			};
-		};
-		i++;
-	};
-
-	return success;
-}
-
-static void init_map(void)
-{
-	uint8_t x,y,z;
-	y=0;
-	while(y != 9)
-	{
-		x=0;
-		while(x != 9)
-		{
-			map_get(COLUMN, x,y)->certain = 0;
-			z = 0;
-			while(z != 10)
-			{
-				map_get(COLUMN, x,y)->possible[z]=z;
-				z++;
-			};
-			x++;
-		};
-		y++;
-	};
-}
-
-// read file, each digit 1-9 represents a solved cell
-// unsolved cells are represented by . or 0
-// ignores all other characters, fails if < 81 cells found
-// returns success
-static uint8_t read_file_map(FILE *fp)
-{
-	char tempchar;
-	uint8_t finished=FALSE;
-	uint8_t success=TRUE;
-	uint8_t tempu8;
-	uint8_t x=0,y=0;
-
-	do
-	{
-		tempu8 = fread(&tempchar, 1, 1, fp);
-
-		if(tempu8==0)
-		{
-			finished=TRUE;
-			success=FALSE;
+			options.batch=TRUE;
+			options.cache=TRUE;
 		}
-		else
+		else if(opt == 'K')
 		{
-			//insert digit?
-			if(tempchar == '.')
-				tempchar = '0';
-			if(('1' <= tempchar) && (tempchar <= '9'))
-			{
-				tempu8 = tempchar & 0x0F;
-				if(map_get(COLUMN, x,y)->possible[tempu8])	//if value possible
-					cell_solve(x,y,tempu8);				//solve cell
-				else
-				{
-					finished=TRUE;
-					success=FALSE;
-				};
-			};
-			//advance to next cell?
-			if(('0' <= tempchar) && (tempchar <= '9'))
-			{
-				x++;
-				if(x==9)
-				{
-					x=0;
-					y++;
-					if(y==9)
-					{
-						finished=TRUE;
-						success=TRUE;
-					};
-				};
-			};
-		};
-	}while(!finished);
-
-	return success;
-}
-
-static void cell_solve(uint8_t x, uint8_t y, uint8_t value)
-{
-	uint8_t	n;
-
-	cells_solved++;
-
-	printf("Solve %i at %i,%i\r\n", value, x+1, y+1);
-
-	//solve cell
-	map_get(COLUMN, x,y)->certain = value;
-
-	n=0;
-	while(n!=9)
-	{
-		map_get(COLUMN, x,y)->possible[n+1]=0;						//remove all candidates within solved cell
-		map_get(ROW,    n_of(ROW,x,y), n)->possible[value]=0;		//remove all candidates from row
-		map_get(COLUMN, n_of(COLUMN,x,y), n)->possible[value]=0;	//remove all candidates from column
-		map_get(SQUARE, n_of(SQUARE,x,y), n)->possible[value]=0;	//remove all candidates from square
-		n++;
-	};
-}
-
-static void show_map(void)
-{
-	uint8_t x, y=0;
-	uint8_t cellx, celly;
-	uint8_t notei;
-
-	printf("\r\n###########################################\r\n");
-	while(y!=27)
-	{
-		x=0;
-		celly = y/3;
-		printf("# ");
-		while(x!=27)
-		{
-			cellx = x/3;
-			if(map_get(COLUMN, cellx,celly)->certain)
-			{
-				if((x%3==1) && (y%3==1))
-					printf("%i", map_get(COLUMN, cellx,celly)->certain);
-				else
-					printf(" ");
-			}
-			else
-			{
-				notei = 1 + (x%3) + (y%3)*3;
-				if(map_get(COLUMN, cellx,celly)->possible[notei])
-					printf("%i", map_get(COLUMN, cellx,celly)->possible[notei]);
-				else
-					printf(" ");
-			};
-			if(x%3 == 2)
-			{
-				if(x%9 == 8)
-					printf(" # ");
-				else
-					printf("|");
-			};
-			x++;
-		};
-		printf("\r\n");
-		if(y%3 == 2)
+			options.batch=TRUE;
+			options.cache=TRUE;
+			options.cache_file = optarg;
+		}
+		else if(opt == 'R')
 		{
-			if(y%9 == 8)
-				printf("###########################################\r\n");
-			else
-				printf("# ---+---+--- # ---+---+--- # ---+---+--- #\r\n");
-		};
-		y++;
-	};
-}
-
-//get RCS n 0-8 of x-y coordinate
-static uint8_t	n_of(uint8_t type, uint8_t x, uint8_t y)
-{
-	uint8_t retval;
-
-	if(type == SQUARE)
-	{
-		x /=3;
-		y /=3;
-		retval = x+y*3;
-	}
-	else if(type == ROW)
-		retval = y;
-	else
-		retval = x;
-
-	return retval;
-}
-
-//get cell index 0-8 of x-y coordinate within it's RCS
-static uint8_t	i_of(uint8_t type, uint8_t x, uint8_t y)
-{
-	uint8_t retval;
-
-	if(type == SQUARE)
-	{
-		x = x%3;
-		y = y%3;
-		retval = x+y*3;
-	}
-	else if(type == ROW)
-		retval = x;
-	else
-		retval = y;
-
-	return retval;
-}
-
-//get x coordinate of cell index i within RCS n
-static uint8_t	x_of(uint8_t type, uint8_t n, uint8_t i)
-{
-	uint8_t retval;
-
-	if(type == SQUARE)
-	{
-		i = i%3;
-		n = n%3;
-		retval = n*3+i;
-	}
-	else if(type == ROW)
-		retval = i;
-	else
-		retval = n;
-
-	return retval;
-}
-
-//get y coordinate of cell index i within RCS n
-static uint8_t	y_of(uint8_t type, uint8_t n, uint8_t i)
-{
-	uint8_t retval;
-
-	if(type == SQUARE)
-	{
-		i /=3;
-		n /=3;
-		retval = n*3+i;
-	}
-	else if(type == ROW)
-		retval = n;
-	else
-		retval = i;
-
-	return retval;
-}
-
-//count how many candidates are in a cell
-static uint8_t cell_possible_count(struct cell_struct *cell)
-{
-	uint8_t count=0;
-	uint8_t index=1;
-	while(index != 10)
-	{
-		if(cell->possible[index])
-			count++;
-		index++;
-	};
-
-	return count;
-}
-
-//count how many true values are in a mask uint8_t[9]
-static uint8_t	count_mask(uint8_t *x_ptr)
-{
-	uint8_t	index=0;
-	uint8_t retval=0;
-
-	while(index != 9)
-	{
-		if(x_ptr[index])
-			retval++;
-		index++;
-	};
-
-	return retval;
-}
-
-//get population count of a candidate within a rcs, also builds a mask if 'mask' is not NULL
-static uint8_t population_in_rcs(uint8_t type, uint8_t n, uint8_t value, uint8_t *mask)
-{
-	uint8_t retval=0;
-	uint8_t i=0;
-
-	while(i != 9)
-	{
-		if(map_get(type, n, i)->possible[value])
+			options.batch=TRUE;
+			options.rate=TRUE;
+		}
+		else if((opt == 'r') && (atoi(optarg) > 0))
+			options.repeat = (unsigned long)atoi(optarg);
+		else if(opt == 'j')
 		{
-			retval++;
-			if(mask)
-				mask[i]=TRUE;
+			options.batch=TRUE;
+			options.threads = atoi(optarg);
+			if(options.threads <= 0)
+				options.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+			if(options.threads > 255)
+				options.threads = 255;
 		}
-		else if(mask)
-			mask[i]=FALSE;
-
-		i++;
-	};
-	return retval;
-}
-
-//used to generate all combinations of a specific size within 'last_index'
-static uint8_t finger_step(uint8_t *thumb_ptr, uint8_t *finger_ptr, uint8_t last_index)
-{
-	uint8_t retval=0;
-
-	if(finger_ptr[0] < last_index)
-		finger_ptr[0]++;
-	else
-	{
-		if(finger_ptr != thumb_ptr)
+		else if(opt == 'c')
 		{
-			retval = finger_step(thumb_ptr, &finger_ptr[1], last_index-1);
-			finger_ptr[0] = finger_ptr[1]+1;
+			options.batch=TRUE;
+			options.count_limit = strtoul(optarg, NULL, 10);
+			if(!options.count_limit)
+				optind = argc;
 		}
+		else if((opt == 'm') && !strcmp(optarg, "explain"))
+			options.mode = SUSOLVE_EXPLAIN;
+		else if((opt == 'm') && !strcmp(optarg, "fast"))
+			options.mode = SUSOLVE_FAST;
+		else if((opt == 'm') && !strcmp(optarg, "lanes"))
+			options.mode = SUSOLVE_LANES;
+		else if((opt == 'o') && !strcmp(optarg, "solution"))
+			options.output = SUSOLVE_OUTPUT_SOLUTION;
+		else if((opt == 'o') && !strcmp(optarg, "steps"))
+			options.output = SUSOLVE_OUTPUT_STEPS;
+		else if((opt == 'o') && !strcmp(optarg, "board"))
+			options.output = SUSOLVE_OUTPUT_BOARD;
+		else if((opt == 't') && !strcmp(optarg, "json"))
+			options.trace = SUSOLVE_TRACE_JSON;
+		else if((opt == 't') && !strcmp(optarg, "binary"))
+			options.trace = SUSOLVE_TRACE_BINARY;
 		else
-			retval=1;//end of search
-	};
-
-	return retval;
-}
-
-//or source mask onto target mask
-static void mask_or(uint8_t *target, uint8_t *source)
-{
-	uint8_t index=0;
-	while(index != 9)
-	{
-		if(source[index])
-			target[index]=TRUE;
-		index++;
-	};
-}
-
-//***********************************************************************************************
-// Map addressing (row/column/square) map array should only be accessed via this function
-//***********************************************************************************************
-
-//get cell# from row/col/square 'n'
-static struct cell_struct* map_get(uint8_t type, uint8_t n, uint8_t cellno)
-{
-	struct cell_struct* ptr;
-	uint8_t x,y,sqx,sqy;
-
-	if(type == COLUMN)
-		ptr = &map[n+cellno*9];
-	else if(type == ROW)
-		ptr = &map[cellno+n*9];
-	else
-	{
-		x = n%3;
-		y = n/3;
-
-		sqx = cellno%3;
-		sqy = cellno/3;
-
-		ptr = &map[(x*3+sqx)+(y*3+sqy)*9];
-	};
-	return ptr;
-}
-
-//*******************************************************
-// Methods
-//*******************************************************
-
-//Sole candidate, if a cell has only one possibility
-static uint8_t sole_candidate(void)
-{
-	uint8_t x, y;
-	uint8_t value;
-	uint8_t index;
-	uint8_t success=FALSE, finished=FALSE;
-	struct cell_struct *cell_ptr;
-
-	x=0;
-	y=0;
-	while(x!=9 && !finished)
-	{
-		y=0;
-		while(y!=9 && !finished)
 		{
-			cell_ptr = map_get(COLUMN, x, y);
-			if(cell_possible_count(cell_ptr)==1)
-			{
-				value=0;
-				index=1;
-				while(index != 10)	//get value
-				{
-					value += cell_ptr->possible[index];
-					index++;
-				};
-				printf("Sole candidate %i at %i,%i\r\n", value, x+1, y+1);
-				cell_solve(x,y,value);
-				finished=TRUE;
-				success=TRUE;
-			};
-			y++;
+			optind = argc;	//unknown option, show usage
+			options.generate = 0;
 		};
-		x++;
 	};
 
-	return success;
-}
+	if(options.bench)
+		return susolve_bench(&argv[optind], argc-optind, &options);
 
-//Unique candidate
-//If a particular number can only be in one place within a row column or square
-static uint8_t unique_candidate(void)
-{
-	uint8_t value=1, type;
-	uint8_t n, i, count, posx, posy;
-	uint8_t finished=FALSE, success=FALSE;
+	if(options.generate && (optind == argc))
+		return susolve_generator(&options);
 
-	while((value !=10) && (!finished))
+	if(optind != argc-1)
 	{
-		//check for unique candidate
-		n=0;
-		while((n != 9) && (!finished))
-		{
-			type=0;
-			while(type !=3)
-			{
-				//count candidates within row/col/square
-				i=0;
-				count=0;
-				while((i != 9) && (count < 2) && !finished)
-				{
-					if(map_get(type, n, i)->possible[value])
-					{
-						count++;
-						posx = x_of(type, n, i);
-						posy = y_of(type, n, i);
-					};
-					i++;
-				};
-				//unique candidate found?
-				if(count==1)
-				{
-					printf("Unique candidate %i found in %s at %i,%i\r\n",value, type_string[type], posx+1, posy+1);
-					cell_solve(posx, posy, value);
-					finished = TRUE;
-					success = TRUE;
-				};
-				type++;
-			};
-			n++;
-		};
-
-		value++;
+		printf("Usage: SuSolve [-b] [-j threads] [-s] [-m explain|fast|lanes] [-c limit] [-a] [-o solution|steps|board] [-t json|binary] [-R] [-C] [-K cache] file\r\n");
+		printf("       SuSolve -B [-r passes] [-m explain|fast] [-a] [file...]\r\n");
+		printf("       SuSolve -G count [-S seed] [-d method [-T misses]] [-s]\r\n");
+		return 1;
 	};
 
-	return success;
-}
-
-//remove from type_b due to pointing in type_a
-static uint8_t pointing(uint8_t type_a, uint8_t type_b)
-{
-	uint8_t	finished=FALSE;
-	uint8_t	success=FALSE;
-	uint8_t	value, n, n_b, i, count;
-	uint8_t	mask[9];
-
-	value=1;
-	while((value !=10) && !finished)
-	{
-		n=0;
-		while(n!=9 && !finished)
-		{
-			count=0;
-			i=0;
-			memset(mask, 1, 9);
-			while((i != 9) && (count !=2))
-			{
-				if(map_get(type_a, n, i)->possible[value])
-				{
-					mask[TRANS_TYPE_I(type_b, type_a, n, i)]=0;
-					if(!count)
-					{
-						n_b = TRANS_TYPE_N(type_b, type_a, n, i);
-						count=1;
-					}
-					else if(n_b != TRANS_TYPE_N(type_b, type_a, n, i))
-						count=2;
-				};
-				i++;
-			};
-			if(count == 1)
-			{
-				if(remove_from(type_b, n_b, &value, 1, mask))
-				{
-					printf("Removing %i from %s %i due to pointing from %s %i\r\n", value, type_string[type_b],n_b+1, type_string[type_a], n+1);
-					finished=TRUE;
-					success=TRUE;
-				};
-			};
-			n++;
-		};
-		value++;
-	};
-	return success;
-}
-
-//naked set (of any size)
-static uint8_t naked_set(void)
-{
-	uint8_t i_a, i_b, n=0;
-	uint8_t set_size=0;
-	uint8_t set_mask[9];
-	uint8_t index;
-	uint8_t type;
-	uint8_t finished=FALSE, success=FALSE;
-
-	while((n != 9) && !finished)
-	{
-		type=0;
-		while(type!=3)
-		{
-			i_a=0;
-			while((i_a != 8) && !finished)
-			{
-				set_size = 1;
-				memset(set_mask, 1, 9);
-				i_b = i_a+1;
-				while(i_b !=9)
-				{
-					//if matching cell, and not solved
-					if(!memcmp(map_get(type, n, i_a)->possible, map_get(type, n, i_b)->possible, 10) && !(map_get(type, n, i_a)->certain))
-					{
-						set_mask[i_a]=0;		//count matching cells and remove from mask
-						set_mask[i_b]=0;
-						set_size++;
-					};
-					i_b++;
-				};
-				if((set_size > 1) && (set_size == cell_possible_count(map_get(type, n, i_a))))	//complete naked set?
-				{
-					if(remove_from(type, n, map_get(type, n, i_a)->possible, 10, set_mask))
-					{
-						printf("Removing candidates ");
-						index=0;
-						while(index !=10)
-						{
-							if(map_get(type, n, i_a)->possible[index])
-								printf("%i, ", index);
-							index++;
-						};
-						printf("from %s %i due to naked set\r\n", type_string[type],n+1);
-						finished=TRUE;
-						success=TRUE;
-					};
-				};
-				i_a++;
-			};
-			type++;
-		};
-		n++;
-	};
-
-	return success;
+	if(options.batch)
+		return susolve_batch(argv[optind], &options);
+	else
+		return susolve_interactive(argv[optind], &options);
 }
 
-//hidden set
-// if N numbers are limited to N cells, then other candidates in those cells may be removed
-// set size is 2-8
-// if 1,2,3,4,5,6,7,8 only occur in cells a,b,c,d,e,f,g,h, any 9's within a-h can be eliminated
-static uint8_t hidden_set(void)
+//technique id of a method name as rated, -1 if unknown
+static int method_id(const char *name)
 {
-	uint8_t type=0;
-	uint8_t n=0;
-	uint8_t value;
-	uint8_t set_size;
-	uint8_t index;
-	uint8_t finished=FALSE, success=FALSE;
-	struct mask_struct mask[10];	// access with mask[value 1-9].mask
-	uint8_t fingers[8];
-	uint8_t tempmask[9];
-	uint8_t remove_list[10];
-	uint8_t flag;
-	type=0;
-	while(type !=3)
-	{
-		n=0;
-		while(n!=9)
-		{
-			//get location masks for each candidate in rcs n
-			value = 1;
-			while(value != 10)
-			{
-				mask[value].count = population_in_rcs(type, n, value, mask[value].mask);
-				value++;
-			};
+	static const char* names[10] = {"sole_candidate", "unique_candidate", "pointing", "naked_set", "hidden_set", "fish", "xy_wing", "coloring", "chain", "search"};
+	int index=0;
 
-			set_size=2;
-			while((set_size < 9) && !finished)
-			{
-				//init fingers
-				index = 0;
-				while(index != set_size)
-				{
-					fingers[index] = set_size-index;
-					index++;
-				};
-
-				do
-				{
-				// fingers[0] -> fingers[set_size-1] are values we need to test for hidden set
-				//	tempmask is or'd masks of values indexed by fingers
-					memset(tempmask, 0, 9);
-					index=0;
-					flag=TRUE;
-					while(index != set_size)
-					{
-						mask_or(tempmask, mask[fingers[index]].mask);
-						if(mask[fingers[index]].count==0)
-							flag=FALSE;
-						index++;
-					};
-					//if hidden set found
-					if(flag && (count_mask(tempmask) == set_size))
-					{
-						//build remove list (all values bar ones in set)
-						index=0;
-						while(index !=10)
-						{
-							remove_list[index]=index;
-							index++;
-						};
-						index = 0;
-						while(index != set_size)
-						{
-							remove_list[fingers[index]] = 0;
-							index++;
-						};
-
-						if(remove_from(type, n, remove_list, 10, tempmask))
-						{
-							printf("Hidden set ");
-							index = 0;
-							while(index != set_size)
-							{
-								printf("%i ", fingers[index]);
-								index++;
-							};
-							printf("in %s %i\r\n", type_string[type], n+1);
-							finished=TRUE;
-							success=TRUE;
-						};
-					};
-				}while(!finished && !finger_step(&fingers[set_size-1], fingers, 9));
-
-				set_size++;
-			};
-			n++;
-		};
-		type++;
-	};
+	if(!strcmp(name, "xwing"))	//the fish technique's earlier name
+		return 5;
+	while((index != 10) && strcmp(name, names[index]))
+		index++;
 
-	return success;
+	return (index != 10) ? index : -1;
 }
 
-//xwing
-//eg. if 7 appears twice only in 2 rows, and in the same positions, eliminate 7 from the columns
-static uint8_t xwing(void)
+#ifdef SUSOLVE_COUNTERS
+//SIGUSR1, the library writes the counters where it can stop safely
+static void counters_signal(int signal)
 {
-	struct mask_struct mask[9];	// access with mask[value].mask
-	uint8_t type=0;
-	uint8_t remove_type;
-	uint8_t n=0;
-	uint8_t value;
-	uint8_t index, i1, i2;
-	uint8_t finished=FALSE, success=FALSE;
-	uint8_t removemask[9];
-	uint8_t flag;
-	uint8_t fingers[2];	//reference positions, so fingers explore values 0-8
-
-	type=0;
-	while(type !=2)
-	{
-		value=1;
-		while(value != 10)
-		{
-			n=0;
-			while(n!=9)
-			{
-				mask[n].count = population_in_rcs(type, n, value, mask[n].mask);
-				n++;
-			};
-			fingers[1]=0;
-			fingers[0]=1;
-			do
-			{
-				//if x-wing found
-				if( (mask[fingers[0]].count == 2) && !memcmp(mask[fingers[0]].mask, mask[fingers[1]].mask, 9))
-				{
-					index=0;
-					i1=99;
-					while(i1==99)
-					{
-						if(mask[fingers[0]].mask[index])
-							i1=index;
-						index++;
-					};
-					i2=99;
-					while(i2==99)
-					{
-						if(mask[fingers[0]].mask[index])
-							i2=index;
-						index++;
-					};
-					memset(removemask, 1, 9);
-					removemask[fingers[0]]=0;
-					removemask[fingers[1]]=0;
-					if(type==ROW)
-						remove_type=COLUMN;
-					else
-						remove_type=ROW;
-					flag = FALSE;
-					if( remove_from(remove_type, i1, &value, 1, removemask) )
-						flag=TRUE;
-					if( remove_from(remove_type, i2, &value, 1, removemask) )
-						flag=TRUE;
-					if(flag)
-					{
-						printf("Removing %i from %s %i and %i due to xwing on %s %i and %i\r\n", value, type_string[remove_type], i1+1, i2+1, type_string[type], fingers[0]+1, fingers[1]+1);
-						success=TRUE;
-						finished=TRUE;
-					};
-				};
-			}while(!finished && !finger_step(&fingers[1], fingers, 8));
-			n++;
-			value++;
-		};
-		type++;
-	};
-	return success;
+	(void)signal;
+	susolve_counters_request();
 }
-
+#endif
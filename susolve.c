@@ -0,0 +1,5602 @@
+/*
+
+libsusolve, solves sudoku using most known human methods, see susolve.h for the interface
+
+All positions are indexed from 0 (column 0-8, row 0-8 etc).
+All values are referenced as actual values 1-9 (no 0)
+
+The grid size is set at compile time by SUSOLVE_BOX (see susolve.h), 9x9 is described here.
+For other sizes read SIZE for 9, CELLS for 81 and BOX for 3, the masks are as wide as they need to be.
+
+3 cell addressing schemes
+
+	X-Y coodrdinates
+
+	Cell number (0-80), across then down, so x + y*9
+	The lookup tables convert cell numbers to and from the other schemes
+
+	N-I
+	N is row/column/square (0-8)
+	I is cell index(0-8) within that row/column/square
+	Squares are numbered top left to bottom right, accross then down
+	Columns are left to right (same X)
+	Rows are top to bottom (same Y)
+
+	Terms
+		RCS	Row Column or Square
+		RC	Row or Column
+		Candidate mask	bit 1-9 set for each value still possible in a cell
+		Location mask	bit 0-8 set for each cell index I of an RCS where a value is still possible
+
+*/
+
+	//fileno, open_memstream, clock_gettime and madvise, whatever dialect the compiler defaults to
+	#define _POSIX_C_SOURCE	200809L
+	#define _DEFAULT_SOURCE
+
+    #include <stdio.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include <stdlib.h>
+    #include <unistd.h>
+    #include <pthread.h>
+    #include <time.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include "susolve.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#if SUSOLVE_BOX == 3
+	#define SIMD_X86	//SSE2 and AVX2 kernels are built, and picked at run time by simd_init()
+#endif
+#endif
+
+//*******************************************************
+// Defines
+//*******************************************************
+
+	#define TRUE	1
+	#define	FALSE	0
+
+	#define ROW		0
+	#define COLUMN	1
+	#define SQUARE	2
+
+	//grid size
+	#define BOX			SUSOLVE_BOX		//cells across a square
+	#define SIZE		SUSOLVE_SIZE	//cells in a row, column or square, and values
+	#define CELLS		SUSOLVE_CELLS
+	#define PEERS		(3*SIZE - 2*BOX - 1)	//cells sharing a row, column or square with a cell
+
+	//mask and cell types, each size gets the narrowest words that hold it
+#if SUSOLVE_BOX <= 3
+	typedef uint16_t	values_t;	//candidate mask
+	typedef uint16_t	places_t;	//location mask, or a mask of n
+	typedef uint32_t	rcs_t;		//RCS mask
+	typedef uint8_t		cell_t;		//cell number, or a count of cells
+#elif SUSOLVE_BOX == 4
+	typedef uint32_t	values_t;
+	typedef uint16_t	places_t;
+	typedef uint64_t	rcs_t;
+	typedef uint16_t	cell_t;
+#elif SUSOLVE_BOX == 5
+	typedef uint32_t	values_t;
+	typedef uint32_t	places_t;
+	typedef unsigned __int128	rcs_t;
+	typedef uint16_t	cell_t;
+#else
+	#error "SUSOLVE_BOX must be 2, 3, 4 or 5"
+#endif
+
+	#define BIT(v)			(1U << (v))
+	#define ALL_VALUES		((values_t)((2ULL << SIZE) - 2))	//candidate mask with values 1-9 set
+	#define ALL_CELLS		((places_t)((1ULL << SIZE) - 1))	//location mask with cell index 0-8 set
+	#define ALL_RCS			((((rcs_t)1) << (3*SIZE)) - 1)		//RCS mask with all 27 rows, columns and squares set
+
+	#define RCS_BIT(type, n)		(((rcs_t)1) << ((n)*3 + (type)))	//RCS masks are ordered by n, then type
+	#define RCS_TYPE_BITS(type)		((ALL_RCS / 7) << (type))	//every RCS of one type
+	#define POINTING_INDEX(type_a, type_b)	((type_a) == SQUARE ? (type_b) : 2+(type_a))
+
+	#define POPCOUNT(m)		((uint8_t)__builtin_popcount(m))
+	#define LOWEST(m)		((uint8_t)__builtin_ctz(m))
+	#define HIGHEST(m)		((uint8_t)(31 - __builtin_clz(m)))
+
+	//lowest set bit of an RCS mask
+#if SUSOLVE_BOX <= 3
+	#define RCS_LOWEST(m)	LOWEST(m)
+#elif SUSOLVE_BOX == 4
+	#define RCS_LOWEST(m)	((uint8_t)__builtin_ctzll(m))
+#else
+	#define RCS_LOWEST(m)	((uint8_t)((uint64_t)(m) ? __builtin_ctzll((uint64_t)(m)) : 64 + __builtin_ctzll((uint64_t)((m) >> 64))))
+#endif
+
+	//cell text, values past 9 are letters
+#if SUSOLVE_SIZE < 10
+	#define VALUE_CHAR(v)	('0' + (v))
+#else
+	#define VALUE_CHAR(v)	((v) < 10 ? '0' + (v) : 'A' - 10 + (v))
+#endif
+	#define NOT_CELL		0xFF	//char_value() of a character that is not a cell
+
+	//largest naked set tried, a larger one leaves a hidden set in the remaining cells
+	#define NAKED_MAX		4
+
+	//largest hidden set tried, past 4 the combinations explode on the larger grids
+	#define HIDDEN_MAX		(SUSOLVE_BOX <= 3 ? SIZE-1 : 4)
+
+	//largest fish tried, 2 xwing, 3 swordfish, 4 jellyfish
+	#define FISH_MAX		(SIZE/2 < 4 ? SIZE/2 : 4)
+	#define FINNED_MAX		2	//largest finned fish, larger ones widen the search more than they save
+
+	//lines of the band or stack holding line n, as a places_t mask
+	#define BAND_MASK(n)	((places_t)((BIT(BOX)-1) << ((n)/BOX*BOX)))
+
+//	macro to get cells row/column/square n, by specefying it's index within a different column/square/row
+	#define TRANS_TYPE_N(out_type, in_type, in_n, in_i)	cell_rcs[rcs_cell[in_type][in_n][in_i]][out_type]
+
+//	macro to get cells index within it's row/column/square by specefying it's index within a different column/square/row
+	#define TRANS_TYPE_I(out_type, in_type, in_n, in_i) cell_index[rcs_cell[in_type][in_n][in_i]][out_type]
+
+//	X-Y coordinates of a cell (0-80, across then down)
+	#define CELL_X(cell)	cell_rcs[cell][COLUMN]
+	#define CELL_Y(cell)	cell_rcs[cell][ROW]
+
+	//solving methods, as timed by the benchmark
+	#define METHOD_SOLE		0
+	#define METHOD_UNIQUE	1
+	#define METHOD_POINTING	2
+	#define METHOD_NAKED	3
+	#define METHOD_HIDDEN	4
+	#define METHOD_FISH		5
+	#define METHOD_XYWING	6
+	#define METHOD_COLORING	7
+	#define METHOD_CHAIN	8
+	#define METHOD_SEARCH	9
+	#define METHOD_DLX		10
+	#define METHODS			11
+
+	//rating, RATE_LEVEL per level of the hardest method used (the method number+1), plus the steps weighted by rate_weight[]
+	#define RATE_LEVEL		1000
+	#define RATE_EFFORT		(RATE_LEVEL-1)	//the steps never reach the next level
+
+#ifdef SUSOLVE_COUNTERS
+	//hot path counters, kept per context and summed by counters_add()
+	//every field is a uint64_t so they can be summed and printed as an array
+	struct counters_struct
+	{
+		uint64_t	method_runs[METHODS];	//calls of each method (search counts nodes)
+		uint64_t	method_hits[METHODS];	//calls that made progress
+		uint64_t	pointing_runs[4];		//by POINTING_INDEX(type_a, type_b)
+		uint64_t	pointing_hits[4];
+		uint64_t	naked_sets;				//cell sets tested by naked_set()
+		uint64_t	hidden_sets;			//value sets tested by hidden_set()
+		uint64_t	fish_sets;				//base line sets tested by fish()
+		uint64_t	chain_starts;			//candidates chain() followed links from
+		uint64_t	remove_calls;			//remove_from() calls
+		uint64_t	remove_empty;			//remove_from() calls that eliminated nothing
+		uint64_t	cells_solved;			//cell_solve() calls
+		uint64_t	candidates_removed;		//by cell_remove()
+	};
+
+	#define COUNTERS			(sizeof(struct counters_struct) / sizeof(uint64_t))
+	#define COUNT(ctx, counter)			((ctx)->counters.counter++)
+	#define COUNT_ADD(ctx, counter, n)	((ctx)->counters.counter += (n))
+#else
+	#define COUNT(ctx, counter)			((void)0)
+	#define COUNT_ADD(ctx, counter, n)	((void)0)
+#endif
+
+	//step log entries, deductions are numbered as the method that made them
+	#define STEP_SOLE		METHOD_SOLE		//sole candidate in cell
+	#define STEP_UNIQUE		METHOD_UNIQUE	//unique candidate in rcs_a of type_a, at cell
+	#define STEP_POINTING	METHOD_POINTING	//values removed from rcs_b of type_b, due to pointing from rcs_a of type_a
+	#define STEP_NAKED		METHOD_NAKED	//values removed from rcs_a of type_a, due to a naked set
+	#define STEP_HIDDEN		METHOD_HIDDEN	//hidden set of values in rcs_a of type_a
+	#define STEP_FISH		METHOD_FISH		//values removed from rcs_b of type_b, due to a fish on rcs_a of type_a, cell is a fin or CELLS
+	#define STEP_XYWING		METHOD_XYWING	//value removed from cells seeing both pincers cell_b and cell_c, of the pivot at cell
+	#define STEP_COLORING	METHOD_COLORING	//value removed by simple coloring of its conjugates, type_a the rule, cell and cell_b the colours that give it
+	#define STEP_CHAIN		METHOD_CHAIN	//value removed from cells seeing both ends of a chain, cell and cell_b, type_a the kind of chain
+	#define STEP_SOLVE		METHODS			//cell solved, by a given or by the deduction before it
+	#define STEP_LINKED(kind)	(((kind) >= STEP_XYWING) && ((kind) <= STEP_CHAIN))	//names cells rather than houses
+
+	#define COLOR_TRAP		0	//cells seeing both colours of a chain of conjugates lose the value
+	#define COLOR_WRAP		1	//two cells of one colour share a house, that colour loses the value
+	#define CHAIN_X			0	//chain of one value, its conjugates
+	#define CHAIN_AIC		1	//alternating inference chain, conjugates and bivalue cells
+	#define CHAIN_MAX		8	//most strong links followed from the start of a chain
+
+	#define STEP_LOG		256		//initial steps allocated in a step log
+	#define STEP_ELIMS		1024	//initial eliminations allocated in a step log
+
+	//trace formats
+	#define TRACE_NONE		SUSOLVE_TRACE_NONE
+	#define TRACE_JSON		SUSOLVE_TRACE_JSON		//JSON Lines
+	#define TRACE_BINARY	SUSOLVE_TRACE_BINARY	//fixed little endian records
+
+	#define TRACE_SOLVED	0	//trace result codes
+	#define TRACE_UNSOLVED	1
+	#define TRACE_ERROR		2
+	#define TRACE_END		0xFF	//binary record id ending a puzzle
+	#define TRACE_NONE_ID	0xFF	//binary cell or house type not used by a step
+
+	//one deduction, as recorded while solving, formatted only when the log is written
+	//rcs_a and rcs_b are masks of n, so a step can name several rows, columns or squares
+	struct step_struct
+	{
+		uint8_t		kind;
+		cell_t		cell;
+		values_t	values;		//candidate mask
+		cell_t		cell_b;		//other cells named by chain methods, CELLS if not
+		cell_t		cell_c;
+		uint8_t		type_a;
+		uint8_t		type_b;
+		places_t	rcs_a;
+		places_t	rcs_b;
+		uint16_t	elims;		//candidates removed, elim[first_elim] onwards in the log
+		uint32_t	first_elim;
+	};
+
+	//a candidate removed by a deduction
+	struct step_elim
+	{
+		cell_t		cell;
+		uint8_t		value;
+	};
+
+	//a fish being searched for, base lines of type holding value
+	struct fish_struct
+	{
+		uint8_t		type;
+		uint8_t		cover_type;	//the other of ROW and COLUMN
+		uint8_t		value;
+		uint8_t		size;		//base lines wanted
+		uint8_t		finned;		//fins allowed
+		uint8_t		found;
+	};
+
+	//a candidate reached by chain(), known on (true) or off (false) if the start is off
+	struct link_node
+	{
+		cell_t		cell;
+		uint8_t		value;
+		uint8_t		on;
+		uint8_t		links;		//strong links followed to reach it
+	};
+
+	//links between candidates, built from the candidates by links_build() when a chain method first needs them,
+	//then shared by xy_wing(), coloring() and chain() for the rest of the solve_step()
+	//too big for the stack on the larger grids, so held beside the context by whoever owns it (see sudoku_ctx.links)
+	//a strong link (one of the two is true) joins the only two places of a value in a row, column or square,
+	//or the two values of a bivalue cell, a weak link (not both true) joins a value in peers, or values in a cell
+	struct link_graph
+	{
+		uint8_t		built;		//reached[] is clear once built
+		cell_t		conjugate[CELLS][SIZE+1][3];	//by RCS type, the other place of the value, or CELLS if there are more
+		cell_t		bivalue[CELLS];					//cells with two candidates
+		cell_t		bivalues;
+
+		//chain() work space, candidates reached as on and off, and the queue of them still to follow
+		uint8_t				reached[CELLS][SIZE+1];
+		struct link_node	queue[2*CELLS*SIZE];
+	};
+
+	//steps recorded since the log was last written
+	//eliminations are recorded as they happen, and belong to the next step added
+	struct step_log
+	{
+		struct step_struct	*step;
+		uint32_t			count;
+		uint32_t			size;	//allocated
+		struct step_elim	*elim;
+		uint32_t			elims;
+		uint32_t			elim_size;
+		uint32_t			pending;	//first elimination not yet claimed by a step
+		uint32_t			lost;		//steps or eliminations not recorded for lack of memory
+	};
+
+	//for each cell store possible 1-9 and solved value
+	//0 indicates not possible/not solved
+	struct cell_struct
+	{
+		values_t	possible;	//bit 0 not used, bits 1-9 set to represent possible
+		uint8_t		certain;	//solved value
+	};
+
+	//everything needed to solve one puzzle, contexts are independent of each other
+	struct sudoku_ctx
+	{
+		struct cell_struct map[CELLS];
+
+		//location masks, bit i set if value is possible at cell index i within RCS n
+		//kept in step with map[] by cell_remove(), access with location[type][n][value]
+		places_t	location[3][SIZE][SIZE+1];
+
+		//candidate mask of values already solved within RCS n, access with solved[type][n]
+		values_t	solved[3][SIZE];
+
+		//work lists, cell_remove() sets a bit wherever candidates change
+		//each method clears a bit once it has looked there and found nothing, and skips clear bits
+		places_t	dirty_cells[SIZE];			//sole_candidate, bit y of column x
+		rcs_t		dirty_unique[SIZE+1];		//unique_candidate, RCS mask per value
+		rcs_t		dirty_pointing[4][SIZE+1];	//pointing, RCS mask per direction and value
+		rcs_t		dirty_naked;			//naked_set, RCS mask
+		rcs_t		dirty_hidden;			//hidden_set, RCS mask
+		values_t	dirty_fish[2];			//fish, candidate mask per base row/column
+
+		cell_t		cells_solved;
+		struct step_log	*log;		//steps are recorded here if not NULL (init_map() sets NULL)
+		struct link_graph	*links;	//chain method work space, set by the owner of the context (not by init_map()), solve_step() marks it stale
+		uint8_t		apply_all;		//methods apply every deduction they find in one pass, not just the first
+		uint32_t	search_nodes;	//contexts tried by search()
+		uint16_t	method_steps[METHODS];	//steps taken by each solving method, for rating
+
+		//benchmark timing, accumulated over puzzles (init_map() clears timing, not the totals)
+		uint8_t		timing;
+		uint32_t	method_calls[METHODS];
+		uint64_t	method_ns[METHODS];
+
+#ifdef SUSOLVE_COUNTERS
+		struct counters_struct	counters;	//not cleared by init_map()
+#endif
+	};
+
+	#define MODE_EXPLAIN	SUSOLVE_EXPLAIN	//solving methods, then search
+	#define MODE_FAST		SUSOLVE_FAST	//dancing links only
+	#define MODE_LANES		SUSOLVE_LANES	//singles and pointing on LANES puzzles at once, then as explain
+
+	#define OUTPUT_SOLUTION	SUSOLVE_OUTPUT_SOLUTION	//the solved grid only
+	#define OUTPUT_STEPS	SUSOLVE_OUTPUT_STEPS	//step log, then the solved grid
+	#define OUTPUT_BOARD	SUSOLVE_OUTPUT_BOARD	//board with candidates before each step, waiting for enter
+
+	#define DLX_COLUMNS	(CELLS*4)				//constraints, 81 cells + 81 value in row + 81 value in column + 81 value in square
+	#define DLX_ROWS	(CELLS*SIZE)			//cell and value choices
+	#define DLX_NODES	(1+DLX_COLUMNS+DLX_ROWS*4)	//root, column headers, 4 nodes per row (65001 at 25x25, so still 16 bit)
+
+	#define BATCH_LINE	(CELLS*2 > 256 ? CELLS*2 : 256)		//longest line kept from a batch file, the rest is ignored
+	#define BATCH_OUT	(CELLS+2 > 32 ? CELLS+2 : 32)		//longest answer, a solution or a rating such as "4294967295 unique_candidate\n"
+	#define BATCH_CHUNK	8192	//lines read and solved between writes
+
+	#define GENERATE_NODES	20000UL		//dancing links nodes a uniqueness check may take past 9x9, before the given is kept
+	#define GENERATE_MISSES	100000UL	//candidates in a row missing the target before the generator gives up, unless options say otherwise
+	#define CANON_WORK		(1UL << 16)		//rows and orders tried before a canonical form is given up on, only very symmetric puzzles get there
+
+	#define CACHE_SLOTS		1024	//initial slots in the solution cache, doubled when 3/4 full
+
+#if SUSOLVE_BOX == 3
+	#define LANES		16		//puzzles solved in lockstep, one per 16 bit vector lane (9x9 only)
+#endif
+
+#if defined(SIMD_X86) && defined(__GLIBC__)
+	#define LANES_CLONES	__attribute__((target_clones("avx2", "default")))	//AVX2 or SSE2, picked at load time
+#else
+	#define LANES_CLONES
+#endif
+
+#ifdef LANES
+	//one candidate mask per lane, element aligned so it can live in malloc()ed memory
+	typedef uint16_t lanes_t __attribute__((vector_size(LANES*2), aligned(2)));
+
+	//LANES puzzles in structure of arrays layout
+	struct lanes_struct
+	{
+		lanes_t		possible[81];	//candidate masks, 0 once solved
+		lanes_t		certain[81];	//solved value as a candidate mask, 0 if unsolved
+		lanes_t		failed;			//0xFFFF in lanes that reached a contradiction
+		uint32_t	job[LANES];		//batch job in each lane
+		uint8_t		used;			//lanes loaded
+	};
+#endif
+
+	//one line of a batch and its answer
+	struct batch_job
+	{
+		const char	*text;				//the line, in the mapped file or in line[]
+		uint32_t	length;
+		char	line[BATCH_LINE];		//copy of the line when the input can not be mapped
+		char	out[BATCH_OUT];		//the cells and newline, a solution count or rating and newline, or "error" and newline
+		uint16_t	out_length;
+		uint8_t	trace_worker;	//worker holding the trace of this line
+		uint32_t	trace_length;
+		size_t	trace;			//offset in the workers trace
+	};
+
+	//batch input, a regular file is mapped and lines are used where they lie, otherwise read a line at a time
+	struct batch_input
+	{
+		FILE		*fp;
+		const char	*map;	//NULL if not mapped
+		const char	*next;
+		const char	*end;
+		size_t		size;
+	};
+
+	//jobs [head, tail) belong to a worker, others steal from the tail when they run out
+	struct batch_queue
+	{
+		pthread_mutex_t	lock;
+		uint32_t		head;
+		uint32_t		tail;
+	};
+
+	//exact cover matrix for dancing links, in a fixed arena so nothing is allocated per puzzle
+	//node 0 is the root, nodes 1-324 are column headers, rows follow
+	struct dlx_struct
+	{
+		uint16_t	left[DLX_NODES];
+		uint16_t	right[DLX_NODES];
+		uint16_t	up[DLX_NODES];
+		uint16_t	down[DLX_NODES];
+		uint16_t	column[DLX_NODES];		//column header of each node
+		uint16_t	choice[DLX_NODES];		//cell*9 + value-1 of the row each node is in
+		uint16_t	size[DLX_COLUMNS+1];	//nodes in each column
+		uint16_t	partial[CELLS];			//choices made so far
+		uint16_t	solution[CELLS];		//choices of the first solution found
+		cell_t		depth;
+		cell_t		solution_depth;
+		uint32_t	count;					//solutions found
+		uint32_t	limit;					//stop after this many
+		uint32_t	nodes;					//search nodes
+		uint32_t	budget;					//give up after this many nodes, 0 for no limit (dlx_build() sets 0)
+	};
+
+	struct batch_pool;
+
+	//bare grid for the generators uniqueness checks, values used in each RCS and the cells still empty
+	struct generate_struct
+	{
+		values_t	used[3][SIZE];
+		values_t	banned[CELLS];		//values ruled out of a cell, besides those used
+		cell_t		empty[CELLS];
+		cell_t		empties;
+	};
+
+	//candidates of a cell, and placing or taking away a value (the same toggle)
+	#define GENERATE_USED(gen, cell)	((gen)->used[ROW][cell_rcs[cell][ROW]] | (gen)->used[COLUMN][cell_rcs[cell][COLUMN]] | (gen)->used[SQUARE][cell_rcs[cell][SQUARE]] | (gen)->banned[cell])
+	#define GENERATE_PLACE(gen, cell, value)	do{ (gen)->used[ROW][cell_rcs[cell][ROW]] ^= BIT(value); (gen)->used[COLUMN][cell_rcs[cell][COLUMN]] ^= BIT(value); (gen)->used[SQUARE][cell_rcs[cell][SQUARE]] ^= BIT(value); }while(0)
+
+	//an order of the columns, with the stacks and columns still free to swap
+	//stacks or columns that tie can swap with their neighbours, tied runs are the groups canon_refine() sorts
+	struct canon_order
+	{
+		uint8_t		stack[BOX];			//stack at each place
+		uint8_t		column[BOX][BOX];	//columns of each stack, in order
+		uint8_t		stack_ties;			//bit p set if the stack at place p ties with the one before
+		uint8_t		column_ties[BOX];	//per stack, bit i set if its column i ties with the one before
+	};
+
+	//a puzzle in canonical form and the transformation giving it, see canon_map()
+	//equivalent puzzles (digits relabelled, bands, stacks, rows and columns within them reordered, or transposed) share a form
+	struct canon_struct
+	{
+		uint8_t		grid[2][SIZE][SIZE];	//givens, as read and transposed, 0 if empty
+		uint32_t	columns[2];				//columns of grid[] with givens, a bit each
+		uint8_t		form[CELLS];			//smallest grid found, digits numbered in order of first appearance
+		uint32_t	pattern[SIZE];			//givens of each row of form[], a bit each, the first column highest
+		uint8_t		rows;					//rows of pattern[] settled along the current path
+		uint8_t		improved;				//the current path is below form[]
+		uint8_t		transpose;				//grid[] being tried
+		uint8_t		row[SIZE];				//row of grid[] at each row of the form, so far
+		uint32_t	used;					//rows of grid[] placed so far
+		uint32_t	work;					//rows placed and orders tried
+		struct canon_order	order;			//column order of a complete row order, swapped about by canon_swap()
+		uint8_t		*group[SIZE];			//runs of tied stacks or columns in order, except those with no givens
+		uint8_t		group_size[SIZE];
+		uint8_t		groups;
+		uint8_t		best_transpose;			//transformation giving form[]
+		uint8_t		best_row[SIZE];
+		uint8_t		best_column[SIZE];
+		uint8_t		best_label[SIZE+1];		//digit of form[] for each value
+	};
+
+	//a canonical form and its solution, as digits of the form
+	struct cache_entry
+	{
+		uint64_t	hash;		//0 if the slot is free
+		uint8_t		form[CELLS];
+		uint8_t		solution[CELLS];
+	};
+
+	//solutions by canonical form, open addressing, shared by the batch workers
+	struct cache_struct
+	{
+		pthread_mutex_t		lock;
+		struct cache_entry	*entry;
+		uint32_t			size;		//slots, a power of 2
+		uint32_t			count;		//forms held
+		uint32_t			added;		//since loaded
+		uint32_t			rejected;	//loaded lines whose solution is not a valid grid holding its form
+	};
+
+	//what susolve_new() hands out
+	struct susolve
+	{
+		struct sudoku_ctx	ctx;
+		struct dlx_struct	dlx;
+		struct link_graph	links;
+		struct step_log		log;
+	};
+
+	struct batch_worker
+	{
+		struct batch_pool	*pool;
+		struct batch_queue	queue;
+		struct sudoku_ctx	ctx;
+		struct dlx_struct	dlx;
+		struct link_graph	links;
+#ifdef LANES
+		struct lanes_struct	lanes;
+#endif
+		struct canon_struct	canon;
+		pthread_t			thread;
+		struct step_log		log;
+		FILE				*trace;			//traces of this chunk, open while solving
+		char				*trace_text;	//and once closed
+		size_t				trace_size;
+		uint8_t				index;
+		uint32_t			searched;		//puzzles that needed search
+		uint64_t			search_nodes;	//total nodes over those puzzles
+		uint64_t			cache_hits;		//puzzles answered from the cache
+	};
+
+	//worker threads wait for 'generation' to change, then solve the chunk in jobs[]
+	struct batch_pool
+	{
+		pthread_mutex_t		lock;
+		pthread_cond_t		start;
+		pthread_cond_t		done;
+		uint32_t			generation;
+		uint8_t				busy;		//workers still solving this chunk
+		uint8_t				quit;
+		uint8_t				workers;
+		uint8_t				mode;
+		uint8_t				apply_all;
+		uint8_t				trace;		//TRACE_*, traces replace the usual output
+		uint8_t				rate;		//write a rating per line, not the solution
+		struct cache_struct	*cache;		//solutions of puzzles seen before, NULL if not caching
+		uint32_t			count_limit;
+		uint64_t			first;		//puzzle number of jobs[0]
+		struct batch_worker	*worker;	//worker[0] is the main thread
+		struct batch_job	*jobs;
+	};
+
+//*******************************************************
+// Variables
+//*******************************************************
+
+	static char* type_string[3] = {"row", "column", "square"};
+	static char* mode_string[3] = {"explain", "fast", "lanes"};
+	static char* fish_string[5] = {"", "", "xwing", "swordfish", "jellyfish"};	//by size
+	static char* method_string[METHODS] = {"sole_candidate", "unique_candidate", "pointing", "naked_set", "hidden_set", "fish", "xy_wing", "coloring", "chain", "search", "dlx"};
+	static const uint8_t rate_weight[METHODS] = {1, 2, 4, 8, 12, 16, 18, 20, 24, 20, 20};	//per step, or per search node
+	static char* color_string[2] = {"trap", "wrap"};	//by COLOR_TRAP, COLOR_WRAP
+	static char* chain_string[2] = {"x_chain", "aic"};	//by CHAIN_X, CHAIN_AIC
+	static const char* bench_files[3] = {"puzzles/easy.txt", "puzzles/hard.txt", "puzzles/pathological.txt"};
+
+#ifdef SUSOLVE_COUNTERS
+	static volatile sig_atomic_t counters_wanted;	//set by susolve_counters_request(), counters are written at the next safe point
+	static char* pointing_string[4] = {"square_row", "square_column", "row_square", "column_square"};
+#endif
+
+	//whole map scans, set by simd_init() to the fastest version the processor supports (before main() runs)
+	static uint8_t		(*scan_cells)(const struct cell_struct *map, cell_t *best);
+	static uint8_t		(*scan_locations)(const struct sudoku_ctx *ctx);
+
+//*******************************************************
+// Lookup tables, so cell addressing is never calculated
+//*******************************************************
+
+#if SUSOLVE_BOX == 3
+
+	//cell (0-80, across then down) of cell index i within RCS n, access with rcs_cell[type][n][i]
+	static const cell_t rcs_cell[3][9][9] =
+	{
+		{	//rows
+			{ 0,  1,  2,  3,  4,  5,  6,  7,  8},
+			{ 9, 10, 11, 12, 13, 14, 15, 16, 17},
+			{18, 19, 20, 21, 22, 23, 24, 25, 26},
+			{27, 28, 29, 30, 31, 32, 33, 34, 35},
+			{36, 37, 38, 39, 40, 41, 42, 43, 44},
+			{45, 46, 47, 48, 49, 50, 51, 52, 53},
+			{54, 55, 56, 57, 58, 59, 60, 61, 62},
+			{63, 64, 65, 66, 67, 68, 69, 70, 71},
+			{72, 73, 74, 75, 76, 77, 78, 79, 80}
+		},
+		{	//columns
+			{ 0,  9, 18, 27, 36, 45, 54, 63, 72},
+			{ 1, 10, 19, 28, 37, 46, 55, 64, 73},
+			{ 2, 11, 20, 29, 38, 47, 56, 65, 74},
+			{ 3, 12, 21, 30, 39, 48, 57, 66, 75},
+			{ 4, 13, 22, 31, 40, 49, 58, 67, 76},
+			{ 5, 14, 23, 32, 41, 50, 59, 68, 77},
+			{ 6, 15, 24, 33, 42, 51, 60, 69, 78},
+			{ 7, 16, 25, 34, 43, 52, 61, 70, 79},
+			{ 8, 17, 26, 35, 44, 53, 62, 71, 80}
+		},
+		{	//squares
+			{ 0,  1,  2,  9, 10, 11, 18, 19, 20},
+			{ 3,  4,  5, 12, 13, 14, 21, 22, 23},
+			{ 6,  7,  8, 15, 16, 17, 24, 25, 26},
+			{27, 28, 29, 36, 37, 38, 45, 46, 47},
+			{30, 31, 32, 39, 40, 41, 48, 49, 50},
+			{33, 34, 35, 42, 43, 44, 51, 52, 53},
+			{54, 55, 56, 63, 64, 65, 72, 73, 74},
+			{57, 58, 59, 66, 67, 68, 75, 76, 77},
+			{60, 61, 62, 69, 70, 71, 78, 79, 80}
+		}
+	};
+
+	//RCS n and cell index i of each cell, access with cell_rcs[cell][type] and cell_index[cell][type]
+	static const uint8_t cell_rcs[81][3] =
+	{
+		{0, 0, 0}, {0, 1, 0}, {0, 2, 0}, {0, 3, 1}, {0, 4, 1}, {0, 5, 1}, {0, 6, 2}, {0, 7, 2}, {0, 8, 2},
+		{1, 0, 0}, {1, 1, 0}, {1, 2, 0}, {1, 3, 1}, {1, 4, 1}, {1, 5, 1}, {1, 6, 2}, {1, 7, 2}, {1, 8, 2},
+		{2, 0, 0}, {2, 1, 0}, {2, 2, 0}, {2, 3, 1}, {2, 4, 1}, {2, 5, 1}, {2, 6, 2}, {2, 7, 2}, {2, 8, 2},
+		{3, 0, 3}, {3, 1, 3}, {3, 2, 3}, {3, 3, 4}, {3, 4, 4}, {3, 5, 4}, {3, 6, 5}, {3, 7, 5}, {3, 8, 5},
+		{4, 0, 3}, {4, 1, 3}, {4, 2, 3}, {4, 3, 4}, {4, 4, 4}, {4, 5, 4}, {4, 6, 5}, {4, 7, 5}, {4, 8, 5},
+		{5, 0, 3}, {5, 1, 3}, {5, 2, 3}, {5, 3, 4}, {5, 4, 4}, {5, 5, 4}, {5, 6, 5}, {5, 7, 5}, {5, 8, 5},
+		{6, 0, 6}, {6, 1, 6}, {6, 2, 6}, {6, 3, 7}, {6, 4, 7}, {6, 5, 7}, {6, 6, 8}, {6, 7, 8}, {6, 8, 8},
+		{7, 0, 6}, {7, 1, 6}, {7, 2, 6}, {7, 3, 7}, {7, 4, 7}, {7, 5, 7}, {7, 6, 8}, {7, 7, 8}, {7, 8, 8},
+		{8, 0, 6}, {8, 1, 6}, {8, 2, 6}, {8, 3, 7}, {8, 4, 7}, {8, 5, 7}, {8, 6, 8}, {8, 7, 8}, {8, 8, 8}
+	};
+
+	static const uint8_t cell_index[81][3] =
+	{
+		{0, 0, 0}, {1, 0, 1}, {2, 0, 2}, {3, 0, 0}, {4, 0, 1}, {5, 0, 2}, {6, 0, 0}, {7, 0, 1}, {8, 0, 2},
+		{0, 1, 3}, {1, 1, 4}, {2, 1, 5}, {3, 1, 3}, {4, 1, 4}, {5, 1, 5}, {6, 1, 3}, {7, 1, 4}, {8, 1, 5},
+		{0, 2, 6}, {1, 2, 7}, {2, 2, 8}, {3, 2, 6}, {4, 2, 7}, {5, 2, 8}, {6, 2, 6}, {7, 2, 7}, {8, 2, 8},
+		{0, 3, 0}, {1, 3, 1}, {2, 3, 2}, {3, 3, 0}, {4, 3, 1}, {5, 3, 2}, {6, 3, 0}, {7, 3, 1}, {8, 3, 2},
+		{0, 4, 3}, {1, 4, 4}, {2, 4, 5}, {3, 4, 3}, {4, 4, 4}, {5, 4, 5}, {6, 4, 3}, {7, 4, 4}, {8, 4, 5},
+		{0, 5, 6}, {1, 5, 7}, {2, 5, 8}, {3, 5, 6}, {4, 5, 7}, {5, 5, 8}, {6, 5, 6}, {7, 5, 7}, {8, 5, 8},
+		{0, 6, 0}, {1, 6, 1}, {2, 6, 2}, {3, 6, 0}, {4, 6, 1}, {5, 6, 2}, {6, 6, 0}, {7, 6, 1}, {8, 6, 2},
+		{0, 7, 3}, {1, 7, 4}, {2, 7, 5}, {3, 7, 3}, {4, 7, 4}, {5, 7, 5}, {6, 7, 3}, {7, 7, 4}, {8, 7, 5},
+		{0, 8, 6}, {1, 8, 7}, {2, 8, 8}, {3, 8, 6}, {4, 8, 7}, {5, 8, 8}, {6, 8, 6}, {7, 8, 7}, {8, 8, 8}
+	};
+
+	//the 20 cells sharing a row, column or square with each cell, access with cell_peers[cell][0-19]
+	static const cell_t cell_peers[81][20] =
+	{
+		{ 1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 18, 19, 20, 27, 36, 45, 54, 63, 72},	//0
+		{ 0,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 18, 19, 20, 28, 37, 46, 55, 64, 73},	//1
+		{ 0,  1,  3,  4,  5,  6,  7,  8,  9, 10, 11, 18, 19, 20, 29, 38, 47, 56, 65, 74},	//2
+		{ 0,  1,  2,  4,  5,  6,  7,  8, 12, 13, 14, 21, 22, 23, 30, 39, 48, 57, 66, 75},	//3
+		{ 0,  1,  2,  3,  5,  6,  7,  8, 12, 13, 14, 21, 22, 23, 31, 40, 49, 58, 67, 76},	//4
+		{ 0,  1,  2,  3,  4,  6,  7,  8, 12, 13, 14, 21, 22, 23, 32, 41, 50, 59, 68, 77},	//5
+		{ 0,  1,  2,  3,  4,  5,  7,  8, 15, 16, 17, 24, 25, 26, 33, 42, 51, 60, 69, 78},	//6
+		{ 0,  1,  2,  3,  4,  5,  6,  8, 15, 16, 17, 24, 25, 26, 34, 43, 52, 61, 70, 79},	//7
+		{ 0,  1,  2,  3,  4,  5,  6,  7, 15, 16, 17, 24, 25, 26, 35, 44, 53, 62, 71, 80},	//8
+		{ 0,  1,  2, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 27, 36, 45, 54, 63, 72},	//9
+		{ 0,  1,  2,  9, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 28, 37, 46, 55, 64, 73},	//10
+		{ 0,  1,  2,  9, 10, 12, 13, 14, 15, 16, 17, 18, 19, 20, 29, 38, 47, 56, 65, 74},	//11
+		{ 3,  4,  5,  9, 10, 11, 13, 14, 15, 16, 17, 21, 22, 23, 30, 39, 48, 57, 66, 75},	//12
+		{ 3,  4,  5,  9, 10, 11, 12, 14, 15, 16, 17, 21, 22, 23, 31, 40, 49, 58, 67, 76},	//13
+		{ 3,  4,  5,  9, 10, 11, 12, 13, 15, 16, 17, 21, 22, 23, 32, 41, 50, 59, 68, 77},	//14
+		{ 6,  7,  8,  9, 10, 11, 12, 13, 14, 16, 17, 24, 25, 26, 33, 42, 51, 60, 69, 78},	//15
+		{ 6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 17, 24, 25, 26, 34, 43, 52, 61, 70, 79},	//16
+		{ 6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16, 24, 25, 26, 35, 44, 53, 62, 71, 80},	//17
+		{ 0,  1,  2,  9, 10, 11, 19, 20, 21, 22, 23, 24, 25, 26, 27, 36, 45, 54, 63, 72},	//18
+		{ 0,  1,  2,  9, 10, 11, 18, 20, 21, 22, 23, 24, 25, 26, 28, 37, 46, 55, 64, 73},	//19
+		{ 0,  1,  2,  9, 10, 11, 18, 19, 21, 22, 23, 24, 25, 26, 29, 38, 47, 56, 65, 74},	//20
+		{ 3,  4,  5, 12, 13, 14, 18, 19, 20, 22, 23, 24, 25, 26, 30, 39, 48, 57, 66, 75},	//21
+		{ 3,  4,  5, 12, 13, 14, 18, 19, 20, 21, 23, 24, 25, 26, 31, 40, 49, 58, 67, 76},	//22
+		{ 3,  4,  5, 12, 13, 14, 18, 19, 20, 21, 22, 24, 25, 26, 32, 41, 50, 59, 68, 77},	//23
+		{ 6,  7,  8, 15, 16, 17, 18, 19, 20, 21, 22, 23, 25, 26, 33, 42, 51, 60, 69, 78},	//24
+		{ 6,  7,  8, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 26, 34, 43, 52, 61, 70, 79},	//25
+		{ 6,  7,  8, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 35, 44, 53, 62, 71, 80},	//26
+		{ 0,  9, 18, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 45, 46, 47, 54, 63, 72},	//27
+		{ 1, 10, 19, 27, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 45, 46, 47, 55, 64, 73},	//28
+		{ 2, 11, 20, 27, 28, 30, 31, 32, 33, 34, 35, 36, 37, 38, 45, 46, 47, 56, 65, 74},	//29
+		{ 3, 12, 21, 27, 28, 29, 31, 32, 33, 34, 35, 39, 40, 41, 48, 49, 50, 57, 66, 75},	//30
+		{ 4, 13, 22, 27, 28, 29, 30, 32, 33, 34, 35, 39, 40, 41, 48, 49, 50, 58, 67, 76},	//31
+		{ 5, 14, 23, 27, 28, 29, 30, 31, 33, 34, 35, 39, 40, 41, 48, 49, 50, 59, 68, 77},	//32
+		{ 6, 15, 24, 27, 28, 29, 30, 31, 32, 34, 35, 42, 43, 44, 51, 52, 53, 60, 69, 78},	//33
+		{ 7, 16, 25, 27, 28, 29, 30, 31, 32, 33, 35, 42, 43, 44, 51, 52, 53, 61, 70, 79},	//34
+		{ 8, 17, 26, 27, 28, 29, 30, 31, 32, 33, 34, 42, 43, 44, 51, 52, 53, 62, 71, 80},	//35
+		{ 0,  9, 18, 27, 28, 29, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 54, 63, 72},	//36
+		{ 1, 10, 19, 27, 28, 29, 36, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 55, 64, 73},	//37
+		{ 2, 11, 20, 27, 28, 29, 36, 37, 39, 40, 41, 42, 43, 44, 45, 46, 47, 56, 65, 74},	//38
+		{ 3, 12, 21, 30, 31, 32, 36, 37, 38, 40, 41, 42, 43, 44, 48, 49, 50, 57, 66, 75},	//39
+		{ 4, 13, 22, 30, 31, 32, 36, 37, 38, 39, 41, 42, 43, 44, 48, 49, 50, 58, 67, 76},	//40
+		{ 5, 14, 23, 30, 31, 32, 36, 37, 38, 39, 40, 42, 43, 44, 48, 49, 50, 59, 68, 77},	//41
+		{ 6, 15, 24, 33, 34, 35, 36, 37, 38, 39, 40, 41, 43, 44, 51, 52, 53, 60, 69, 78},	//42
+		{ 7, 16, 25, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 44, 51, 52, 53, 61, 70, 79},	//43
+		{ 8, 17, 26, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 51, 52, 53, 62, 71, 80},	//44
+		{ 0,  9, 18, 27, 28, 29, 36, 37, 38, 46, 47, 48, 49, 50, 51, 52, 53, 54, 63, 72},	//45
+		{ 1, 10, 19, 27, 28, 29, 36, 37, 38, 45, 47, 48, 49, 50, 51, 52, 53, 55, 64, 73},	//46
+		{ 2, 11, 20, 27, 28, 29, 36, 37, 38, 45, 46, 48, 49, 50, 51, 52, 53, 56, 65, 74},	//47
+		{ 3, 12, 21, 30, 31, 32, 39, 40, 41, 45, 46, 47, 49, 50, 51, 52, 53, 57, 66, 75},	//48
+		{ 4, 13, 22, 30, 31, 32, 39, 40, 41, 45, 46, 47, 48, 50, 51, 52, 53, 58, 67, 76},	//49
+		{ 5, 14, 23, 30, 31, 32, 39, 40, 41, 45, 46, 47, 48, 49, 51, 52, 53, 59, 68, 77},	//50
+		{ 6, 15, 24, 33, 34, 35, 42, 43, 44, 45, 46, 47, 48, 49, 50, 52, 53, 60, 69, 78},	//51
+		{ 7, 16, 25, 33, 34, 35, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 53, 61, 70, 79},	//52
+		{ 8, 17, 26, 33, 34, 35, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 62, 71, 80},	//53
+		{ 0,  9, 18, 27, 36, 45, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 72, 73, 74},	//54
+		{ 1, 10, 19, 28, 37, 46, 54, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 72, 73, 74},	//55
+		{ 2, 11, 20, 29, 38, 47, 54, 55, 57, 58, 59, 60, 61, 62, 63, 64, 65, 72, 73, 74},	//56
+		{ 3, 12, 21, 30, 39, 48, 54, 55, 56, 58, 59, 60, 61, 62, 66, 67, 68, 75, 76, 77},	//57
+		{ 4, 13, 22, 31, 40, 49, 54, 55, 56, 57, 59, 60, 61, 62, 66, 67, 68, 75, 76, 77},	//58
+		{ 5, 14, 23, 32, 41, 50, 54, 55, 56, 57, 58, 60, 61, 62, 66, 67, 68, 75, 76, 77},	//59
+		{ 6, 15, 24, 33, 42, 51, 54, 55, 56, 57, 58, 59, 61, 62, 69, 70, 71, 78, 79, 80},	//60
+		{ 7, 16, 25, 34, 43, 52, 54, 55, 56, 57, 58, 59, 60, 62, 69, 70, 71, 78, 79, 80},	//61
+		{ 8, 17, 26, 35, 44, 53, 54, 55, 56, 57, 58, 59, 60, 61, 69, 70, 71, 78, 79, 80},	//62
+		{ 0,  9, 18, 27, 36, 45, 54, 55, 56, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74},	//63
+		{ 1, 10, 19, 28, 37, 46, 54, 55, 56, 63, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74},	//64
+		{ 2, 11, 20, 29, 38, 47, 54, 55, 56, 63, 64, 66, 67, 68, 69, 70, 71, 72, 73, 74},	//65
+		{ 3, 12, 21, 30, 39, 48, 57, 58, 59, 63, 64, 65, 67, 68, 69, 70, 71, 75, 76, 77},	//66
+		{ 4, 13, 22, 31, 40, 49, 57, 58, 59, 63, 64, 65, 66, 68, 69, 70, 71, 75, 76, 77},	//67
+		{ 5, 14, 23, 32, 41, 50, 57, 58, 59, 63, 64, 65, 66, 67, 69, 70, 71, 75, 76, 77},	//68
+		{ 6, 15, 24, 33, 42, 51, 60, 61, 62, 63, 64, 65, 66, 67, 68, 70, 71, 78, 79, 80},	//69
+		{ 7, 16, 25, 34, 43, 52, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 71, 78, 79, 80},	//70
+		{ 8, 17, 26, 35, 44, 53, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 78, 79, 80},	//71
+		{ 0,  9, 18, 27, 36, 45, 54, 55, 56, 63, 64, 65, 73, 74, 75, 76, 77, 78, 79, 80},	//72
+		{ 1, 10, 19, 28, 37, 46, 54, 55, 56, 63, 64, 65, 72, 74, 75, 76, 77, 78, 79, 80},	//73
+		{ 2, 11, 20, 29, 38, 47, 54, 55, 56, 63, 64, 65, 72, 73, 75, 76, 77, 78, 79, 80},	//74
+		{ 3, 12, 21, 30, 39, 48, 57, 58, 59, 66, 67, 68, 72, 73, 74, 76, 77, 78, 79, 80},	//75
+		{ 4, 13, 22, 31, 40, 49, 57, 58, 59, 66, 67, 68, 72, 73, 74, 75, 77, 78, 79, 80},	//76
+		{ 5, 14, 23, 32, 41, 50, 57, 58, 59, 66, 67, 68, 72, 73, 74, 75, 76, 78, 79, 80},	//77
+		{ 6, 15, 24, 33, 42, 51, 60, 61, 62, 69, 70, 71, 72, 73, 74, 75, 76, 77, 79, 80},	//78
+		{ 7, 16, 25, 34, 43, 52, 60, 61, 62, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 80},	//79
+		{ 8, 17, 26, 35, 44, 53, 60, 61, 62, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79} 	//80
+	};
+
+#else
+
+	//as above for other sizes, filled in by tables_init() before main() runs
+	static cell_t	rcs_cell[3][SIZE][SIZE];
+	static uint8_t	cell_rcs[CELLS][3];
+	static uint8_t	cell_index[CELLS][3];
+	static cell_t	cell_peers[CELLS][PEERS];
+
+#endif
+
+
+//*******************************************************
+// Prototypes
+//*******************************************************
+
+	static uint8_t		solve_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint8_t mode);
+	static uint32_t		rate_map(const struct sudoku_ctx *ctx, uint8_t *hardest);
+	static uint32_t		count_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint8_t mode, uint32_t limit);
+	static uint8_t		solve_step(struct sudoku_ctx *ctx);
+
+	static void 		init_map(struct sudoku_ctx *ctx);
+	static void			show_map(struct sudoku_ctx *ctx);
+	static void			show_rule(uint8_t band);
+	static void			cell_solve(struct sudoku_ctx *ctx, cell_t cell, uint8_t value);
+	static values_t		cell_remove(struct sudoku_ctx *ctx, cell_t cell, values_t values);
+	static uint8_t		read_file_map(struct sudoku_ctx *ctx, FILE *fp);
+	static uint8_t		read_string_map(struct sudoku_ctx *ctx, const char *str);
+	static uint8_t		read_range_map(struct sudoku_ctx *ctx, const char *start, const char *end);
+	static uint32_t		read_classify(const char *text, uint8_t length);
+	static uint8_t		read_char_map(struct sudoku_ctx *ctx, char tempchar, cell_t *index);
+	static uint8_t		char_value(char tempchar);
+	static void			write_line_map(const struct sudoku_ctx *ctx, char *line);
+	static void			write_grid_map(const struct sudoku_ctx *ctx);
+	static uint8_t 		remove_from(struct sudoku_ctx *ctx, uint8_t type, uint8_t n, values_t values, places_t mask);
+	static uint8_t 		finger_step(uint8_t *fingers, uint8_t size, uint8_t last_index);
+
+//	batch solving
+	static uint8_t		batch_open(struct batch_input *input, const char *filename);
+	static void			batch_rewind(struct batch_input *input);
+	static void			batch_close(struct batch_input *input);
+	static uint32_t		batch_read(struct batch_input *input, struct batch_job *jobs);
+	static void*		batch_thread(void *arg);
+	static void			batch_work(struct batch_worker *worker);
+	static uint8_t		batch_trace_open(struct batch_pool *pool);
+	static void			batch_trace_write(struct batch_pool *pool, uint32_t count);
+	static uint8_t		batch_take(struct batch_worker *worker, uint32_t *job);
+	static void			batch_solve(struct batch_worker *worker, struct batch_job *job);
+
+//	benchmark
+	static uint8_t		bench_file(struct sudoku_ctx *ctx, const char *filename, const struct susolve_options *options, struct batch_job *jobs, const char *separator);
+	static int			bench_compare(const void *a, const void *b);
+	static uint64_t		clock_ns(void);
+	static uint64_t		bench_clock(struct sudoku_ctx *ctx);
+	static void			bench_time(struct sudoku_ctx *ctx, uint8_t method, uint64_t *start);
+
+//	generator
+	static void			generate_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint64_t *state, uint8_t *givens);
+	static uint8_t		generate_unique(struct sudoku_ctx *ctx, struct dlx_struct *dlx, const uint8_t *givens, cell_t cell);
+	static uint32_t		generate_count(struct generate_struct *gen, uint32_t limit);
+	static uint64_t		rng_next(uint64_t *state);
+	static uint32_t		rng_below(uint64_t *state, uint32_t n);
+
+//	canonical forms and the solution cache
+	static uint8_t		canon_map(const struct sudoku_ctx *ctx, struct canon_struct *canon);
+	static void			canon_rows(struct canon_struct *canon, uint8_t level, const struct canon_order *order, uint8_t improved);
+	static uint32_t		canon_refine(const struct canon_struct *canon, struct canon_order *order, uint8_t row);
+	static uint8_t		canon_group(uint8_t ties, uint8_t start);
+	static void			canon_leaf(struct canon_struct *canon, const struct canon_order *order, uint8_t improved);
+	static void			canon_swap(struct canon_struct *canon, uint8_t group, uint8_t index);
+	static void			canon_form(struct canon_struct *canon);
+	static cell_t		canon_cell(const struct canon_struct *canon, cell_t cell);
+	static struct cache_struct*	cache_new(void);
+	static void			cache_free(struct cache_struct *cache);
+	static uint8_t		cache_find(struct cache_struct *cache, const struct canon_struct *canon, char *line);
+	static void			cache_add(struct cache_struct *cache, const struct canon_struct *canon, const struct sudoku_ctx *ctx);
+	static void			cache_put(struct cache_struct *cache, const uint8_t *form, const uint8_t *solution);
+	static uint8_t		cache_grow(struct cache_struct *cache);
+	static struct cache_entry*	cache_slot(struct cache_struct *cache, const uint8_t *form, uint64_t hash);
+	static uint64_t		cache_hash(const uint8_t *form);
+	static uint8_t		cache_load(struct cache_struct *cache, const char *filename);
+	static uint8_t		cache_save(const struct cache_struct *cache, const char *filename);
+	static uint8_t		cache_parse(const char *text, uint8_t *digits);
+	static uint8_t		cache_check(const uint8_t *form, const uint8_t *solution);
+
+//	counters
+#ifdef SUSOLVE_COUNTERS
+	static void			counters_add(struct counters_struct *total, const struct counters_struct *add);
+	static void			counters_write(const struct counters_struct *counters);
+#endif
+
+//	step log
+	static void			step_add(struct step_log *log, uint8_t kind, cell_t cell, values_t values, uint8_t type_a, places_t rcs_a, uint8_t type_b, places_t rcs_b);
+	static void			step_write(struct step_log *log, FILE *fp);
+	static void			step_format(FILE *fp, const struct step_struct *step);
+	static void			step_lines(FILE *fp, places_t rcs);
+	static void			step_elim(struct step_log *log, cell_t cell, uint8_t value);
+	static void			step_cells(struct step_log *log, uint8_t kind, values_t values, uint8_t rule, cell_t cell, cell_t cell_b, cell_t cell_c);
+	static void			trace_write(struct step_log *log, FILE *fp, uint8_t format, uint64_t puzzle, const struct sudoku_ctx *ctx, uint8_t result);
+	static void			trace_json(FILE *fp, const struct step_log *log, const struct step_struct *step, uint64_t puzzle, uint32_t number);
+	static void			trace_houses(FILE *fp, const char *name, uint8_t type, places_t rcs);
+	static void			trace_binary(FILE *fp, const struct step_log *log, const struct step_struct *step);
+
+//	lanes
+#ifdef LANES
+	static uint8_t		lanes_load(struct batch_worker *worker, uint32_t job);
+	static void			lanes_solve(struct batch_worker *worker);
+	static void			lanes_resume(struct batch_worker *worker, uint8_t lane);
+	static void			lanes_propagate(struct lanes_struct *lanes);
+#endif
+
+//	map addressing
+	static struct cell_struct* 	map_get(struct sudoku_ctx *ctx, uint8_t type, uint8_t n, uint8_t cellno);
+#if SUSOLVE_BOX != 3
+	static void			tables_init(void) __attribute__((constructor));
+#endif
+
+//	solving methods
+	static uint8_t 		sole_candidate(struct sudoku_ctx *ctx);
+	static uint8_t 		unique_candidate(struct sudoku_ctx *ctx);
+	static uint8_t 		pointing(struct sudoku_ctx *ctx, uint8_t type_a, uint8_t type_b);
+	static uint8_t 		naked_set(struct sudoku_ctx *ctx);
+	static uint8_t		hidden_set(struct sudoku_ctx *ctx);
+	static uint8_t 		fish(struct sudoku_ctx *ctx);
+	static uint8_t		fish_lines(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t lines, places_t base, places_t cover, uint8_t depth);
+	static uint8_t		fish_cover(const struct fish_struct *fish, places_t cover);
+	static uint8_t		fish_found(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t base, places_t cover);
+	static uint8_t		fish_remove(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t targets, places_t mask);
+	static uint8_t		xy_wing(struct sudoku_ctx *ctx, struct link_graph *links);
+	static uint8_t		coloring(struct sudoku_ctx *ctx, struct link_graph *links);
+	static uint8_t		coloring_test(struct sudoku_ctx *ctx, const cell_t *color, const cell_t *cells, cell_t count, uint8_t value);
+	static uint8_t		chain(struct sudoku_ctx *ctx, struct link_graph *links);
+	static uint8_t		chain_from(struct sudoku_ctx *ctx, struct link_graph *links, cell_t start, uint8_t value, uint8_t kind);
+	static void			links_build(const struct sudoku_ctx *ctx, struct link_graph *links);
+	static uint8_t		links_remove(struct sudoku_ctx *ctx, cell_t a, cell_t b, uint8_t value);
+	static uint8_t		cell_sees(cell_t a, cell_t b);
+
+//	search, when the solving methods stall
+	static uint8_t		search(struct sudoku_ctx *ctx);
+
+//	whole map scans
+	static void			simd_init(void) __attribute__((constructor));
+	static uint8_t		scan_cells_scalar(const struct cell_struct *map, cell_t *best);
+	static uint8_t		scan_locations_scalar(const struct sudoku_ctx *ctx);
+#ifdef SIMD_X86
+	static uint8_t		scan_cells_sse2(const struct cell_struct *map, cell_t *best);
+	static uint8_t		scan_cells_avx2(const struct cell_struct *map, cell_t *best);
+	static uint8_t		scan_locations_sse2(const struct sudoku_ctx *ctx);
+#endif
+
+//	dancing links
+	static uint8_t		dlx_solve(struct sudoku_ctx *ctx, struct dlx_struct *dlx);
+	static uint32_t		dlx_count(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint32_t limit);
+	static void			dlx_build(struct sudoku_ctx *ctx, struct dlx_struct *dlx);
+	static void			dlx_search(struct dlx_struct *dlx);
+	static void			dlx_cover(struct dlx_struct *dlx, uint16_t column);
+	static void			dlx_uncover(struct dlx_struct *dlx, uint16_t column);
+
+//*******************************************************
+// Functions
+//*******************************************************
+
+//solve a single puzzle, showing the map and waiting for enter after each step
+int susolve_interactive(const char *filename, const struct susolve_options *options)
+{
+	uint8_t success = TRUE;
+	uint8_t output = options->output;
+
+	FILE *fp;
+	struct sudoku_ctx ctx;
+	static struct dlx_struct dlx;
+	static struct link_graph links;
+	static struct step_log log;
+
+	init_map(&ctx);
+	ctx.links = &links;
+	if((output != OUTPUT_SOLUTION) || options->trace)
+		ctx.log = &log;
+	ctx.apply_all = options->apply_all;
+#ifdef SUSOLVE_COUNTERS
+	memset(&ctx.counters, 0, sizeof(ctx.counters));
+#endif
+
+	fp = fopen(filename, "r");
+	if(!fp)
+	{
+		success=FALSE;
+		printf("File not found");
+	};
+
+	if(success && options->trace)
+	{
+		//the trace replaces all other output
+		if(!read_file_map(&ctx, fp))
+			trace_write(&log, stdout, options->trace, 0, &ctx, TRACE_ERROR);
+		else
+			trace_write(&log, stdout, options->trace, 0, &ctx, solve_map(&ctx, &dlx, options->mode) ? TRACE_SOLVED : TRACE_UNSOLVED);
+		fclose(fp);
+		success = FALSE;
+	}
+	else if(success)
+	{
+		success = read_file_map(&ctx, fp);
+		step_write(&log, stdout);
+		if(!success)
+			printf("Error in file\r\n\r\n");
+		fclose(fp);
+	};
+
+	if(success && (options->mode == MODE_FAST))
+	{
+		if(output == OUTPUT_BOARD)
+			show_map(&ctx);
+		if(solve_map(&ctx, &dlx, MODE_FAST) && (output != OUTPUT_SOLUTION))
+			printf("Solved by dancing links after %lu nodes\r\n", (unsigned long)ctx.search_nodes);
+		else if(output != OUTPUT_SOLUTION)
+			printf("No solution, dancing links gave up after %lu nodes\r\n", (unsigned long)ctx.search_nodes);
+		if(output == OUTPUT_BOARD)
+			show_map(&ctx);
+		else
+			write_grid_map(&ctx);
+	}
+	else if(success)
+	{
+		while(success && (ctx.cells_solved < CELLS))
+		{
+			if(output == OUTPUT_BOARD)
+				show_map(&ctx);
+			success = solve_step(&ctx);
+			step_write(&log, stdout);
+			if(success && (output == OUTPUT_BOARD))
+            {
+                printf("(enter to continue)\r\n");
+				getchar();
+            };
+#ifdef SUSOLVE_COUNTERS
+			if(counters_wanted)
+			{
+				counters_wanted = 0;
+				counters_write(&ctx.counters);
+			};
+#endif
+		};
+
+		if(ctx.cells_solved < CELLS)
+		{
+			if(output != OUTPUT_SOLUTION)
+				printf("No method left to apply, searching\r\n");
+			ctx.log = NULL;
+			if(search(&ctx) && (output != OUTPUT_SOLUTION))
+				printf("Solved by search after %lu nodes\r\n", (unsigned long)ctx.search_nodes);
+			else if(output != OUTPUT_SOLUTION)
+				printf("No solution, search gave up after %lu nodes\r\n", (unsigned long)ctx.search_nodes);
+		};
+		if(output == OUTPUT_BOARD)
+			show_map(&ctx);
+		else
+			write_grid_map(&ctx);
+	};
+
+	free(log.step);
+	free(log.elim);
+
+#ifdef SUSOLVE_COUNTERS
+	counters_write(&ctx.counters);
+#endif
+
+	return 0;
+}
+
+//solve without output, with the solving methods then search, or with dancing links
+//returns TRUE if solved
+static uint8_t solve_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint8_t mode)
+{
+	uint8_t success=TRUE;
+	uint64_t start;
+	struct step_log *log;
+
+	if(mode == MODE_FAST)
+	{
+		start = bench_clock(ctx);
+		success = dlx_solve(ctx, dlx);
+		bench_time(ctx, METHOD_DLX, &start);
+		return success;
+	};
+
+	while((ctx->cells_solved < CELLS) && solve_step(ctx));
+	if(ctx->cells_solved < CELLS)
+	{
+		log = ctx->log;			//guesses are not deductions
+		ctx->log = NULL;
+		start = bench_clock(ctx);
+		success = search(ctx);
+		bench_time(ctx, METHOD_SEARCH, &start);
+		ctx->log = log;
+	};
+
+	return success;
+}
+
+//count solutions, stopping at 'limit'
+//in explain mode the solving methods are applied first, none assume a unique solution so nothing is lost
+static uint32_t count_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint8_t mode, uint32_t limit)
+{
+	if(mode != MODE_FAST)
+		while((ctx->cells_solved < CELLS) && solve_step(ctx));
+
+	return dlx_count(ctx, dlx, limit);
+}
+
+//rate a solved (or stuck) puzzle by the hardest method it needed, then by the steps taken
+//score = RATE_LEVEL * (hardest method + 1) + weighted steps up to RATE_EFFORT, search counts its nodes as steps
+static uint32_t rate_map(const struct sudoku_ctx *ctx, uint8_t *hardest)
+{
+	uint64_t effort=0;
+	uint8_t method=0;
+
+	*hardest = METHOD_SOLE;
+	while(method != METHOD_SEARCH)
+	{
+		if(ctx->method_steps[method])
+			*hardest = method;
+		effort += ctx->method_steps[method] * rate_weight[method];
+		method++;
+	};
+	if(ctx->search_nodes)
+	{
+		*hardest = METHOD_SEARCH;
+		effort += (uint64_t)ctx->search_nodes * rate_weight[METHOD_SEARCH];
+	};
+
+	return RATE_LEVEL * (*hardest + 1) + (uint32_t)((effort > RATE_EFFORT) ? RATE_EFFORT : effort);
+}
+
+//apply the first solving method that makes progress, in order of simplicity
+//returns FALSE if none could
+static uint8_t solve_step(struct sudoku_ctx *ctx)
+{
+	uint8_t success;
+	uint8_t method = METHOD_SOLE;
+	uint64_t start = bench_clock(ctx);
+
+	ctx->links->built = FALSE;	//rebuilt by the first chain method to run
+
+	success = sole_candidate(ctx);
+	bench_time(ctx, METHOD_SOLE, &start);
+	if(!success)
+	{
+		method = METHOD_UNIQUE;
+		success = unique_candidate(ctx);
+		bench_time(ctx, METHOD_UNIQUE, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_POINTING;
+		success = pointing(ctx, SQUARE, ROW);
+		if(!success)
+			success = pointing(ctx, SQUARE, COLUMN);
+		if(!success)
+			success = pointing(ctx, ROW, SQUARE);
+		if(!success)
+			success = pointing(ctx, COLUMN, SQUARE);
+		bench_time(ctx, METHOD_POINTING, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_NAKED;
+		success = naked_set(ctx);
+		bench_time(ctx, METHOD_NAKED, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_HIDDEN;
+		success = hidden_set(ctx);
+		bench_time(ctx, METHOD_HIDDEN, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_FISH;
+		success = fish(ctx);
+		bench_time(ctx, METHOD_FISH, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_XYWING;
+		success = xy_wing(ctx, ctx->links);
+		bench_time(ctx, METHOD_XYWING, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_COLORING;
+		success = coloring(ctx, ctx->links);
+		bench_time(ctx, METHOD_COLORING, &start);
+	};
+	if(!success)
+	{
+		method = METHOD_CHAIN;
+		success = chain(ctx, ctx->links);
+		bench_time(ctx, METHOD_CHAIN, &start);
+	};
+
+	if(success)
+		ctx->method_steps[method]++;
+	return success;
+}
+
+//*******************************************************
+// Library interface, see susolve.h
+//*******************************************************
+
+struct susolve* susolve_new(void)
+{
+	struct susolve *solver = malloc(sizeof(struct susolve));
+
+	if(solver)
+	{
+		init_map(&solver->ctx);
+		solver->ctx.links = &solver->links;
+		memset(&solver->log, 0, sizeof(solver->log));
+#ifdef SUSOLVE_COUNTERS
+		memset(&solver->ctx.counters, 0, sizeof(solver->ctx.counters));
+#endif
+	};
+
+	return solver;
+}
+
+void susolve_free(struct susolve *solver)
+{
+	if(solver)
+	{
+		free(solver->log.step);
+		free(solver->log.elim);
+	};
+	free(solver);
+}
+
+//clear the grid, ready for a new puzzle
+void susolve_init(struct susolve *solver, unsigned flags)
+{
+	init_map(&solver->ctx);
+	solver->ctx.log = (flags & SUSOLVE_STEPS) ? &solver->log : NULL;
+	solver->log.count = 0;
+	solver->log.elims = 0;
+	solver->log.pending = 0;
+	solver->log.lost = 0;
+	solver->ctx.apply_all = (flags & SUSOLVE_APPLY_ALL) ? TRUE : FALSE;
+}
+
+//load givens from a string, digits 1-9 (then letters on larger grids) are solved cells, '.' or '0' unsolved, anything else is ignored
+//returns FALSE if fewer than 81 cells are found or the givens conflict
+int susolve_load(struct susolve *solver, const char *grid)
+{
+	return read_string_map(&solver->ctx, grid);
+}
+
+//as susolve_load(), reading up to the end of the file
+int susolve_load_file(struct susolve *solver, FILE *fp)
+{
+	return read_file_map(&solver->ctx, fp);
+}
+
+//apply the simplest solving method that makes progress, returns FALSE if none could
+int susolve_step(struct susolve *solver)
+{
+	return solve_step(&solver->ctx);
+}
+
+//solve to the end, searching if the solving methods stall, returns TRUE if solved
+int susolve_solve(struct susolve *solver, int mode)
+{
+	return solve_map(&solver->ctx, &solver->dlx, (uint8_t)mode);
+}
+
+//count solutions of the loaded puzzle, stopping at 'limit'
+unsigned long susolve_count(struct susolve *solver, int mode, unsigned long limit)
+{
+	return count_map(&solver->ctx, &solver->dlx, (uint8_t)mode, (uint32_t)limit);
+}
+
+//value of a cell 0-80, 0 if unsolved
+int susolve_get_cell(const struct susolve *solver, int cell)
+{
+	return ((cell >= 0) && (cell < CELLS)) ? solver->ctx.map[cell].certain : 0;
+}
+
+//81 characters across then down, '.' for unsolved cells, and a terminating null
+void susolve_get_grid(const struct susolve *solver, char *grid)
+{
+	write_line_map(&solver->ctx, grid);
+	grid[CELLS] = 0;
+}
+
+int susolve_cells_solved(const struct susolve *solver)
+{
+	return solver->ctx.cells_solved;
+}
+
+//search or dancing links nodes used since susolve_init()
+unsigned long susolve_search_nodes(const struct susolve *solver)
+{
+	return solver->ctx.search_nodes;
+}
+
+//the cells solved so far in canonical form, as susolve_get_grid(), so call it straight after loading a puzzle
+//returns 0 for puzzles so symmetric that the form was given up on
+int susolve_canonical(const struct susolve *solver, char *grid)
+{
+	struct canon_struct canon;
+	cell_t cell=0;
+
+	if(!canon_map(&solver->ctx, &canon))
+		return FALSE;
+
+	while(cell != CELLS)
+	{
+		grid[cell] = canon.form[cell] ? VALUE_CHAR(canon.form[cell]) : '.';
+		cell++;
+	};
+	grid[CELLS] = 0;
+
+	return TRUE;
+}
+
+//write the steps recorded since the last call (SUSOLVE_STEPS), one per line, and empty the log
+void susolve_write_steps(struct susolve *solver, FILE *fp)
+{
+	step_write(&solver->log, fp);
+}
+
+//a random puzzle with a unique solution, from which no given can be taken away
+//81 characters, '.' for blanks, and a terminating null, the seed is advanced so calls can be repeated
+//the solver is left empty, load the puzzle to solve or rate it
+void susolve_generate(struct susolve *solver, unsigned long long *seed, char *grid)
+{
+	uint64_t state = *seed;
+	uint8_t givens[CELLS];
+	cell_t cell=0;
+
+	generate_map(&solver->ctx, &solver->dlx, &state, givens);
+	while(cell != CELLS)
+	{
+		grid[cell] = givens[cell] ? VALUE_CHAR(givens[cell]) : '.';
+		cell++;
+	};
+	grid[CELLS] = 0;
+	init_map(&solver->ctx);
+	*seed = state;
+}
+
+//solve by the solving methods, then search, and rate the puzzle, see susolve.h
+//returns 0 if there is no solution
+unsigned long susolve_rate(struct susolve *solver, int *hardest)
+{
+	uint8_t method;
+	uint32_t score;
+
+	if(!solve_map(&solver->ctx, &solver->dlx, MODE_EXPLAIN))
+		return 0;
+	score = rate_map(&solver->ctx, &method);
+	if(hardest)
+		*hardest = method;
+
+	return score;
+}
+
+//write the deductions recorded since the last call (SUSOLVE_STEPS) as a trace, ending with the grid, and empty the log
+void susolve_write_trace(struct susolve *solver, FILE *fp, int format, unsigned long long puzzle)
+{
+	uint8_t result = (solver->ctx.cells_solved == CELLS) ? TRACE_SOLVED : TRACE_UNSOLVED;
+
+	trace_write(&solver->log, fp, (format == TRACE_BINARY) ? TRACE_BINARY : TRACE_JSON, puzzle, &solver->ctx, result);
+}
+
+//print the grid with candidates to stdout
+void susolve_show(struct susolve *solver)
+{
+	show_map(&solver->ctx);
+}
+
+//ask for the counters to be written at the next safe point, safe to call from a signal handler
+void susolve_counters_request(void)
+{
+#ifdef SUSOLVE_COUNTERS
+	counters_wanted = 1;
+#endif
+}
+
+//*******************************************************
+// Batch solving
+//*******************************************************
+
+//solve one puzzle per line, writing one line per puzzle, nothing else is output
+//lines are read in chunks, each chunk is shared between the threads and written in input order
+int susolve_batch(const char *filename, const struct susolve_options *options)
+{
+	struct batch_input input;
+	struct batch_pool pool;
+	uint32_t count, index;
+	uint64_t puzzles=0, searched=0, search_nodes=0, cache_hits=0;
+	uint8_t w, caching;
+	int threads = options->threads;
+	int retval=0;
+#ifdef SUSOLVE_COUNTERS
+	struct counters_struct counters;
+#endif
+
+	if(!batch_open(&input, filename))
+	{
+		fprintf(stderr, "File not found\r\n");
+		return 1;
+	};
+
+	memset(&pool, 0, sizeof(pool));
+	pool.mode = options->mode;
+	pool.count_limit = (uint32_t)options->count_limit;
+	pool.apply_all = options->apply_all;
+	pool.trace = options->count_limit ? TRACE_NONE : options->trace;
+	pool.rate = options->rate && !options->count_limit && !pool.trace;
+	pool.jobs = malloc(BATCH_CHUNK * sizeof(struct batch_job));
+	pool.worker = malloc(threads * sizeof(struct batch_worker));
+	caching = options->cache && !pool.count_limit && !pool.trace && !pool.rate;	//only solutions are cached
+	pool.cache = caching ? cache_new() : NULL;
+	if(!pool.jobs || !pool.worker || (caching && !pool.cache))
+	{
+		fprintf(stderr, "Out of memory\r\n");
+		retval = 1;
+		threads = 0;
+	}
+	else if(pool.cache && options->cache_file && !cache_load(pool.cache, options->cache_file))
+		fprintf(stderr, "Cache file not read\r\n");
+	else if(pool.cache && pool.cache->rejected)
+		fprintf(stderr, "%lu cache entries rejected, their solutions do not fit their puzzles\r\n", (unsigned long)pool.cache->rejected);
+
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.start, NULL);
+	pthread_cond_init(&pool.done, NULL);
+
+	//start workers, the main thread is worker 0
+	pool.workers=0;
+	while(pool.workers != threads)
+	{
+		w = pool.workers;
+		pool.worker[w].pool = &pool;
+		pool.worker[w].index = w;
+		pool.worker[w].searched = 0;
+		pool.worker[w].search_nodes = 0;
+		pool.worker[w].cache_hits = 0;
+		pool.worker[w].ctx.links = &pool.worker[w].links;
+		memset(&pool.worker[w].log, 0, sizeof(pool.worker[w].log));
+#ifdef SUSOLVE_COUNTERS
+		memset(&pool.worker[w].ctx.counters, 0, sizeof(pool.worker[w].ctx.counters));
+#endif
+		pthread_mutex_init(&pool.worker[w].queue.lock, NULL);
+		if(w && pthread_create(&pool.worker[w].thread, NULL, batch_thread, &pool.worker[w]))
+		{
+			pthread_mutex_destroy(&pool.worker[w].queue.lock);
+			break;	//carry on with the threads we have
+		};
+		pool.workers++;
+	};
+
+	setvbuf(stdout, NULL, _IOFBF, 1<<16);
+
+	while(pool.workers && (count = batch_read(&input, pool.jobs)))
+	{
+		//deal out equal shares
+		w=0;
+		while(w != pool.workers)
+		{
+			pool.worker[w].queue.head = (uint32_t)(((uint64_t)count * w) / pool.workers);
+			pool.worker[w].queue.tail = (uint32_t)(((uint64_t)count * (w+1)) / pool.workers);
+			w++;
+		};
+		pool.first = puzzles;
+		if(pool.trace && !batch_trace_open(&pool))
+		{
+			fprintf(stderr, "Out of memory\r\n");
+			retval = 1;
+			break;
+		};
+
+		pthread_mutex_lock(&pool.lock);
+		pool.busy = pool.workers-1;
+		pool.generation++;
+		pthread_cond_broadcast(&pool.start);
+		pthread_mutex_unlock(&pool.lock);
+
+		batch_work(&pool.worker[0]);
+
+		pthread_mutex_lock(&pool.lock);
+		while(pool.busy)
+			pthread_cond_wait(&pool.done, &pool.lock);
+		pthread_mutex_unlock(&pool.lock);
+
+		if(pool.trace)
+			batch_trace_write(&pool, count);
+		else
+		{
+			index=0;
+			while(index != count)
+			{
+				fwrite(pool.jobs[index].out, 1, pool.jobs[index].out_length, stdout);
+				index++;
+			};
+		};
+		puzzles += count;
+
+#ifdef SUSOLVE_COUNTERS
+		//workers are idle between chunks
+		if(counters_wanted)
+		{
+			counters_wanted = 0;
+			memset(&counters, 0, sizeof(counters));
+			w=0;
+			while(w != pool.workers)
+				counters_add(&counters, &pool.worker[w++].ctx.counters);
+			counters_write(&counters);
+		};
+#endif
+	};
+
+	//stop workers
+	pthread_mutex_lock(&pool.lock);
+	pool.quit = TRUE;
+	pthread_cond_broadcast(&pool.start);
+	pthread_mutex_unlock(&pool.lock);
+	w=0;
+	while(w != pool.workers)
+	{
+		if(w)
+			pthread_join(pool.worker[w].thread, NULL);
+		pthread_mutex_destroy(&pool.worker[w].queue.lock);
+		free(pool.worker[w].log.step);
+		free(pool.worker[w].log.elim);
+		searched += pool.worker[w].searched;
+		search_nodes += pool.worker[w].search_nodes;
+		cache_hits += pool.worker[w].cache_hits;
+		w++;
+	};
+
+	if(options->stats)
+		fprintf(stderr, "%llu puzzles, %llu needed search, %llu search nodes\r\n",
+			(unsigned long long)puzzles, (unsigned long long)searched, (unsigned long long)search_nodes);
+
+	if(pool.cache)
+	{
+		if(options->stats)
+			fprintf(stderr, "%llu answered from the cache, %lu forms cached\r\n", (unsigned long long)cache_hits, (unsigned long)pool.cache->count);
+		if(options->cache_file && pool.cache->added && !cache_save(pool.cache, options->cache_file))
+		{
+			fprintf(stderr, "Cache file not written\r\n");
+			retval = 1;
+		};
+		cache_free(pool.cache);
+	};
+
+#ifdef SUSOLVE_COUNTERS
+	memset(&counters, 0, sizeof(counters));
+	w=0;
+	while(w != pool.workers)
+		counters_add(&counters, &pool.worker[w++].ctx.counters);
+	counters_write(&counters);
+#endif
+
+	pthread_cond_destroy(&pool.done);
+	pthread_cond_destroy(&pool.start);
+	pthread_mutex_destroy(&pool.lock);
+	free(pool.worker);
+	free(pool.jobs);
+
+	batch_close(&input);
+	fflush(stdout);
+
+	return retval;
+}
+
+//open a batch file, or stdin for "-", mapping it if it is a regular file
+//returns FALSE if it can not be opened
+static uint8_t batch_open(struct batch_input *input, const char *filename)
+{
+	struct stat info;
+	void *map;
+
+	memset(input, 0, sizeof(*input));
+	if(!strcmp(filename, "-"))
+		input->fp = stdin;
+	else
+		input->fp = fopen(filename, "r");
+	if(!input->fp)
+		return FALSE;
+
+	if(!fstat(fileno(input->fp), &info) && S_ISREG(info.st_mode) && (info.st_size > 0) && ((uint64_t)info.st_size <= SIZE_MAX))
+	{
+		map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileno(input->fp), 0);
+		if(map != MAP_FAILED)
+		{
+			madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+			input->map = map;
+			input->size = (size_t)info.st_size;
+			input->next = input->map;
+			input->end = input->map + input->size;
+		};
+	};
+
+	return TRUE;
+}
+
+//back to the first line
+static void batch_rewind(struct batch_input *input)
+{
+	if(input->map)
+		input->next = input->map;
+	else
+		rewind(input->fp);
+}
+
+static void batch_close(struct batch_input *input)
+{
+	if(input->map)
+		munmap((void*)input->map, input->size);
+	if(input->fp != stdin)
+		fclose(input->fp);
+}
+
+//read up to BATCH_CHUNK lines, returns number read
+//lines of a mapped file are not copied, only their first BATCH_LINE-1 characters are used either way
+static uint32_t batch_read(struct batch_input *input, struct batch_job *jobs)
+{
+	uint32_t count=0;
+	size_t length;
+	const char *newline;
+	char skip[BATCH_LINE];
+
+	if(input->map)
+	{
+		while((count != BATCH_CHUNK) && (input->next != input->end))
+		{
+			newline = memchr(input->next, '\n', input->end - input->next);
+			length = newline ? (size_t)(newline+1 - input->next) : (size_t)(input->end - input->next);
+			jobs[count].text = input->next;
+			jobs[count].length = (uint32_t)(length < BATCH_LINE ? length : BATCH_LINE-1);
+			input->next += length;
+			count++;
+		};
+		return count;
+	};
+
+	while((count != BATCH_CHUNK) && fgets(jobs[count].line, BATCH_LINE, input->fp))
+	{
+		length = strlen(jobs[count].line);
+		jobs[count].text = jobs[count].line;
+		jobs[count].length = (uint32_t)length;
+
+		//drop the remainder of an over long line
+		while(length && (jobs[count].line[length-1] != '\n') && fgets(skip, BATCH_LINE, input->fp))
+		{
+			length = strlen(skip);
+			if(length && (skip[length-1] == '\n'))
+				length = 0;
+		};
+		count++;
+	};
+
+	return count;
+}
+
+//worker thread, solves a share of every chunk until told to quit
+static void* batch_thread(void *arg)
+{
+	struct batch_worker *worker = arg;
+	struct batch_pool *pool = worker->pool;
+	uint32_t generation=0;
+	uint8_t quit=FALSE;
+
+	while(!quit)
+	{
+		pthread_mutex_lock(&pool->lock);
+		while((pool->generation == generation) && !pool->quit)
+			pthread_cond_wait(&pool->start, &pool->lock);
+		generation = pool->generation;
+		quit = pool->quit;
+		pthread_mutex_unlock(&pool->lock);
+
+		if(!quit)
+		{
+			batch_work(worker);
+
+			pthread_mutex_lock(&pool->lock);
+			pool->busy--;
+			if(!pool->busy)
+				pthread_cond_signal(&pool->done);
+			pthread_mutex_unlock(&pool->lock);
+		};
+	};
+
+	return NULL;
+}
+
+//give each worker somewhere to write the traces of this chunk
+static uint8_t batch_trace_open(struct batch_pool *pool)
+{
+	uint8_t w=0;
+
+	while(w != pool->workers)
+	{
+		pool->worker[w].trace_text = NULL;
+		pool->worker[w].trace = open_memstream(&pool->worker[w].trace_text, &pool->worker[w].trace_size);
+		if(!pool->worker[w].trace)
+		{
+			while(w--)
+			{
+				fclose(pool->worker[w].trace);
+				free(pool->worker[w].trace_text);
+			};
+			return FALSE;
+		};
+		w++;
+	};
+
+	return TRUE;
+}
+
+//write the traces of the chunk in input order, then free them
+static void batch_trace_write(struct batch_pool *pool, uint32_t count)
+{
+	struct batch_job *job;
+	uint32_t index;
+	uint8_t w;
+
+	w=0;
+	while(w != pool->workers)
+		fclose(pool->worker[w++].trace);
+
+	index=0;
+	while(index != count)
+	{
+		job = &pool->jobs[index];
+		fwrite(pool->worker[job->trace_worker].trace_text + job->trace, 1, job->trace_length, stdout);
+		index++;
+	};
+
+	w=0;
+	while(w != pool->workers)
+		free(pool->worker[w++].trace_text);
+}
+
+//solve jobs from our own queue, then from others, until none are left
+static void batch_work(struct batch_worker *worker)
+{
+	struct batch_pool *pool = worker->pool;
+	uint32_t job;
+
+#ifdef LANES
+	worker->lanes.used = 0;
+	while(batch_take(worker, &job))
+	{
+		if((pool->mode != MODE_LANES) || pool->count_limit || pool->trace || pool->rate || pool->cache)
+			batch_solve(worker, &pool->jobs[job]);
+		else if(lanes_load(worker, job) == LANES)
+			lanes_solve(worker);
+	};
+
+	if(worker->lanes.used)
+		lanes_solve(worker);
+#else
+	//no lanes at this size, batch_solve() takes lanes mode as explain
+	while(batch_take(worker, &job))
+		batch_solve(worker, &pool->jobs[job]);
+#endif
+}
+
+//take the next job from the head of our queue
+//if it is empty steal the top half of another workers queue, returns FALSE if all are empty
+static uint8_t batch_take(struct batch_worker *worker, uint32_t *job)
+{
+	struct batch_pool *pool = worker->pool;
+	struct batch_queue *victim;
+	uint32_t start=0, end=0;
+	uint8_t w, tries;
+	uint8_t success=FALSE;
+
+	pthread_mutex_lock(&worker->queue.lock);
+	if(worker->queue.head != worker->queue.tail)
+	{
+		*job = worker->queue.head++;
+		success=TRUE;
+	};
+	pthread_mutex_unlock(&worker->queue.lock);
+
+	w = worker->index;
+	tries = pool->workers;
+	while(!success && --tries)
+	{
+		w = (w+1) % pool->workers;
+		victim = &pool->worker[w].queue;
+		pthread_mutex_lock(&victim->lock);
+		if(victim->head != victim->tail)
+		{
+			end = victim->tail;
+			start = end - (end - victim->head + 1)/2;
+			victim->tail = start;
+			success=TRUE;
+		};
+		pthread_mutex_unlock(&victim->lock);
+
+		if(success)
+		{
+			*job = start;
+			pthread_mutex_lock(&worker->queue.lock);
+			worker->queue.head = start+1;
+			worker->queue.tail = end;
+			pthread_mutex_unlock(&worker->queue.lock);
+		};
+	};
+
+	return success;
+}
+
+//solve one line, leaving the answer in job->out
+static void batch_solve(struct batch_worker *worker, struct batch_job *job)
+{
+	struct sudoku_ctx *ctx = &worker->ctx;
+	struct batch_pool *pool = worker->pool;
+	uint32_t count;
+	uint8_t result, hardest, known;
+
+	init_map(ctx);
+	ctx->apply_all = pool->apply_all;
+	if(pool->trace)
+	{
+		ctx->log = &worker->log;
+		job->trace_worker = worker->index;
+		job->trace = (size_t)ftell(worker->trace);
+		if(!read_range_map(ctx, job->text, job->text + job->length))
+			result = TRACE_ERROR;
+		else
+			result = solve_map(ctx, &worker->dlx, pool->mode) ? TRACE_SOLVED : TRACE_UNSOLVED;
+		trace_write(&worker->log, worker->trace, pool->trace, pool->first + (uint64_t)(job - pool->jobs), ctx, result);
+		job->trace_length = (uint32_t)((size_t)ftell(worker->trace) - job->trace);
+	}
+	else if(!read_range_map(ctx, job->text, job->text + job->length))
+	{
+		memcpy(job->out, "error\n", 6);
+		job->out_length = 6;
+	}
+	else if(pool->count_limit)
+	{
+		count = count_map(ctx, &worker->dlx, pool->mode, pool->count_limit);
+		job->out_length = (uint16_t)snprintf(job->out, BATCH_OUT, "%lu\n", (unsigned long)count);
+	}
+	else if(pool->rate)
+	{
+		//always by the solving methods, dancing links would say nothing about difficulty
+		if(solve_map(ctx, &worker->dlx, MODE_EXPLAIN))
+		{
+			count = rate_map(ctx, &hardest);
+			job->out_length = (uint16_t)snprintf(job->out, BATCH_OUT, "%lu %s\n", (unsigned long)count, method_string[hardest]);
+		}
+		else
+		{
+			memcpy(job->out, "unsolvable\n", 11);
+			job->out_length = 11;
+		};
+	}
+	else
+	{
+		//equivalent puzzles share a canonical form, only the first is solved
+		known = pool->cache && canon_map(ctx, &worker->canon);
+		if(known && cache_find(pool->cache, &worker->canon, job->out))
+			worker->cache_hits++;
+		else
+		{
+			result = solve_map(ctx, &worker->dlx, pool->mode);
+			write_line_map(ctx, job->out);
+			if(known && result)
+				cache_add(pool->cache, &worker->canon, ctx);
+		};
+		job->out[CELLS] = '\n';
+		job->out_length = CELLS+1;
+	};
+
+	if(ctx->search_nodes)
+	{
+		worker->searched++;
+		worker->search_nodes += ctx->search_nodes;
+	};
+}
+
+//*******************************************************
+// Benchmark
+//*******************************************************
+
+//benchmark each file (or the bundled ones), writing one JSON object to stdout
+int susolve_bench(char **filenames, int files, const struct susolve_options *options)
+{
+	static struct sudoku_ctx ctx;	//counters (if built with them) build up over every file
+	static struct link_graph links;
+	struct batch_job *jobs;
+	int index=0;
+	uint8_t success=TRUE;
+
+	//puzzles are timed one at a time, lanes mode would only be explain mode under another name
+	if(options->mode == MODE_LANES)
+	{
+		fprintf(stderr, "Lanes mode can not be benchmarked\r\n");
+		return 1;
+	};
+
+	if(!files)
+	{
+		filenames = (char**)bench_files;
+		files = 3;
+	};
+
+	//every file is checked before anything is written, so the JSON is never left half done
+	while(index != files)
+	{
+		if(access(filenames[index], R_OK))
+		{
+			fprintf(stderr, "File not found: %s\r\n", filenames[index]);
+			return 1;
+		};
+		index++;
+	};
+
+	jobs = malloc(BATCH_CHUNK * sizeof(struct batch_job));
+	if(!jobs)
+	{
+		fprintf(stderr, "Out of memory\r\n");
+		return 1;
+	};
+
+	ctx.links = &links;
+	printf("{\n\t\"mode\": \"%s\",\n\t\"passes\": %lu,\n\t\"files\": [", mode_string[options->mode], (unsigned long)options->repeat);
+	index=0;
+	while(success && (index != files))
+	{
+		success = bench_file(&ctx, filenames[index], options, jobs, index ? ",\n" : "\n");
+		index++;
+	};
+	printf("\n\t]\n}\n");
+
+#ifdef SUSOLVE_COUNTERS
+	counters_write(&ctx.counters);
+#endif
+
+	free(jobs);
+	return success ? 0 : 1;
+}
+
+//solve every puzzle in a file one at a time, 'repeat' times over, and write its JSON object
+//puzzles are timed from reading the line to having the answer, nothing is written if it fails
+static uint8_t bench_file(struct sudoku_ctx *ctx, const char *filename, const struct susolve_options *options, struct batch_job *jobs, const char *separator)
+{
+	static struct dlx_struct dlx;
+	struct batch_input input;
+	uint64_t *latency=NULL, *grown, start, total=0;
+	uint32_t puzzles=0, allocated=0, solved=0, errors=0, pass, count, index;
+	uint8_t method;
+
+	if(!batch_open(&input, filename))
+	{
+		fprintf(stderr, "File not found: %s\r\n", filename);
+		return FALSE;
+	};
+
+	memset(ctx->method_calls, 0, sizeof(ctx->method_calls));
+	memset(ctx->method_ns, 0, sizeof(ctx->method_ns));
+
+	pass=0;
+	while(pass != (uint32_t)options->repeat)
+	{
+		batch_rewind(&input);
+		while((count = batch_read(&input, jobs)))
+		{
+			if(puzzles + count > allocated)
+			{
+				allocated = (puzzles + count) * 2;
+				grown = realloc(latency, allocated * sizeof(uint64_t));
+				if(!grown)
+				{
+					fprintf(stderr, "Out of memory\r\n");
+					free(latency);
+					batch_close(&input);
+					return FALSE;
+				};
+				latency = grown;
+			};
+
+			index=0;
+			while(index != count)
+			{
+				start = clock_ns();
+
+				init_map(ctx);
+				ctx->apply_all = options->apply_all;
+				ctx->timing = TRUE;
+				if(!read_range_map(ctx, jobs[index].text, jobs[index].text + jobs[index].length))
+					errors++;
+				else if(solve_map(ctx, &dlx, options->mode) && (ctx->cells_solved == CELLS))
+					solved++;
+
+				latency[puzzles] = clock_ns() - start;
+				total += latency[puzzles];
+				puzzles++;
+				index++;
+			};
+		};
+		pass++;
+	};
+	batch_close(&input);
+
+#ifdef SUSOLVE_COUNTERS
+	if(counters_wanted)
+	{
+		counters_wanted = 0;
+		counters_write(&ctx->counters);
+	};
+#endif
+
+	if(puzzles)
+		qsort(latency, puzzles, sizeof(uint64_t), bench_compare);
+
+	printf("%s\t\t{\n\t\t\t\"file\": \"%s\",\n", separator, filename);
+	printf("\t\t\t\"puzzles\": %lu,\n\t\t\t\"solved\": %lu,\n\t\t\t\"errors\": %lu,\n", (unsigned long)puzzles, (unsigned long)solved, (unsigned long)errors);
+	printf("\t\t\t\"seconds\": %.6f,\n", total / 1e9);
+	printf("\t\t\t\"puzzles_per_second\": %.1f,\n", total ? puzzles / (total / 1e9) : 0.0);
+	printf("\t\t\t\"latency_us\": {\"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+		puzzles ? latency[(puzzles-1) / 2] / 1e3 : 0.0,
+		puzzles ? latency[((uint64_t)(puzzles-1) * 99) / 100] / 1e3 : 0.0,
+		puzzles ? latency[puzzles-1] / 1e3 : 0.0);
+	printf("\t\t\t\"methods\": {");
+	method=0;
+	while(method != METHODS)
+	{
+		printf("%s\n\t\t\t\t\"%s\": {\"calls\": %lu, \"us\": %.3f}", method ? "," : "",
+			method_string[method], (unsigned long)ctx->method_calls[method], ctx->method_ns[method] / 1e3);
+		method++;
+	};
+	printf("\n\t\t\t}\n\t\t}");
+
+	free(latency);
+	return TRUE;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+
+	return (x > y) - (x < y);
+}
+
+//monotonic time in nanoseconds
+static uint64_t clock_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+//start time for bench_time(), 0 if ctx is not being timed
+static uint64_t bench_clock(struct sudoku_ctx *ctx)
+{
+	return ctx->timing ? clock_ns() : 0;
+}
+
+//add the time since *start to a method, and restart from now
+static void bench_time(struct sudoku_ctx *ctx, uint8_t method, uint64_t *start)
+{
+	uint64_t now;
+
+	if(!ctx->timing)
+		return;
+	now = clock_ns();
+	ctx->method_ns[method] += now - *start;
+	ctx->method_calls[method]++;
+	*start = now;
+}
+
+//*******************************************************
+// Generator
+//*******************************************************
+
+//write puzzles with a unique solution, rated, one per line as "puzzle score technique"
+//with a target only puzzles whose hardest technique is the target are written
+int susolve_generator(const struct susolve_options *options)
+{
+	static struct sudoku_ctx ctx;
+	static struct dlx_struct dlx;
+	static struct link_graph links;
+	uint64_t state = options->seed;
+	uint64_t start = clock_ns();
+	unsigned long written=0, tried=0, missed=0;
+	unsigned long misses = options->misses ? options->misses : GENERATE_MISSES;
+	uint8_t givens[CELLS];
+	uint8_t hardest;
+	cell_t cell;
+	uint32_t score;
+	char line[CELLS];
+	double seconds;
+
+	ctx.links = &links;
+	setvbuf(stdout, NULL, _IOFBF, 1<<16);
+
+	while(written != options->generate)
+	{
+		generate_map(&ctx, &dlx, &state, givens);
+		tried++;
+
+		init_map(&ctx);
+		cell=0;
+		while(cell != CELLS)
+		{
+			if(givens[cell])
+				cell_solve(&ctx, cell, givens[cell]);
+			line[cell] = givens[cell] ? VALUE_CHAR(givens[cell]) : '.';
+			cell++;
+		};
+		solve_map(&ctx, &dlx, MODE_EXPLAIN);
+		score = rate_map(&ctx, &hardest);
+
+		if((options->target < 0) || (options->target == hardest))
+		{
+			printf("%.*s %lu %s\n", CELLS, line, (unsigned long)score, method_string[hardest]);
+			written++;
+			missed=0;
+		}
+		else if(++missed == misses)
+			break;	//the target is too rare (or can not happen on this grid size) to keep on looking
+	};
+	fflush(stdout);
+
+	if(written != options->generate)
+		fprintf(stderr, "Gave up after %lu puzzles in a row without %s as the hardest technique, %lu written\r\n",
+			missed, method_string[options->target], written);
+
+	if(options->stats)
+	{
+		seconds = (clock_ns() - start) / 1e9;
+		fprintf(stderr, "%lu puzzles written, %lu generated, %.3f s, %.0f generated per second\r\n",
+			written, tried, seconds, seconds > 0 ? tried / seconds : 0);
+	};
+
+	return (written == options->generate) ? 0 : 1;
+}
+
+//a minimal puzzle with a unique solution, as values 1-9 per cell, 0 for blanks (near minimal past 9x9, see generate_unique())
+//a random full grid, then each given in random order is taken away if the solution stays unique
+static void generate_map(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint64_t *state, uint8_t *givens)
+{
+	cell_t order[CELLS];
+	uint8_t square, value;
+	cell_t cell, index, i;
+
+	//the diagonal squares share no row or column, fill them at random and complete the grid
+	//not every fill completes (about half fail on 4x4), so fill again until one does
+	do
+	{
+		init_map(ctx);
+		square=0;
+		while(square != SIZE+BOX)		//0, 4 and 8
+		{
+			index=0;
+			while(index != SIZE)
+			{
+				order[index] = index+1;
+				index++;
+			};
+			index=SIZE;
+			while(index != 1)
+			{
+				i = (cell_t)rng_below(state, index);
+				index--;
+				value = order[i];
+				order[i] = order[index];
+				order[index] = value;
+			};
+			index=0;
+			while(index != SIZE)
+			{
+				cell_solve(ctx, rcs_cell[SQUARE][square][index], order[index]);
+				index++;
+			};
+			square += BOX+1;
+		};
+	}while(!dlx_solve(ctx, dlx));
+
+	cell=0;
+	while(cell != CELLS)
+	{
+		givens[cell] = ctx->map[cell].certain;
+		order[cell] = cell;
+		cell++;
+	};
+
+	//shuffle the cells, then try taking each away
+	cell=CELLS;
+	while(cell != 1)
+	{
+		i = (cell_t)rng_below(state, cell);
+		cell--;
+		index = order[i];
+		order[i] = order[cell];
+		order[cell] = index;
+	};
+	cell=0;
+	while(cell != CELLS)
+	{
+		if(generate_unique(ctx, dlx, givens, order[cell]))
+			givens[order[cell]] = 0;
+		cell++;
+	};
+}
+
+//TRUE if the givens, without 'cell', still have only the one solution
+//that is, if nothing else can go in 'cell', checked on bare masks, most cells are settled without any search
+//past 9x9 the search on bare masks (singles only) can take minutes, so those grids search with dancing links on ctx
+static uint8_t generate_unique(struct sudoku_ctx *ctx, struct dlx_struct *dlx, const uint8_t *givens, cell_t cell)
+{
+	struct generate_struct gen;
+	cell_t index=0;
+
+	memset(gen.used, 0, sizeof(gen.used));
+	memset(gen.banned, 0, sizeof(gen.banned));
+	gen.empties = 0;
+	while(index != CELLS)
+	{
+		if(givens[index] && (index != cell))
+		{
+			gen.used[ROW][cell_rcs[index][ROW]] |= BIT(givens[index]);
+			gen.used[COLUMN][cell_rcs[index][COLUMN]] |= BIT(givens[index]);
+			gen.used[SQUARE][cell_rcs[index][SQUARE]] |= BIT(givens[index]);
+		}
+		else
+			gen.empty[gen.empties++] = index;
+		index++;
+	};
+
+	//anything else in 'cell'?
+	if(!(ALL_VALUES & ~BIT(givens[cell]) & ~GENERATE_USED(&gen, cell)))
+		return TRUE;
+
+	if(SUSOLVE_BOX > 3)
+	{
+		init_map(ctx);
+		index=0;
+		while(index != CELLS)
+		{
+			if(givens[index] && (index != cell))
+				cell_solve(ctx, index, givens[index]);
+			index++;
+		};
+		cell_remove(ctx, cell, BIT(givens[cell]));
+
+		//a search that runs out of nodes proves nothing, so the given stays (the puzzle may not quite be minimal)
+		dlx_build(ctx, dlx);
+		dlx->limit = 1;
+		dlx->budget = GENERATE_NODES;
+		dlx_search(dlx);
+		return !dlx->count && (dlx->nodes < GENERATE_NODES);
+	};
+
+	gen.banned[cell] = BIT(givens[cell]);
+
+	return !generate_count(&gen, 1);
+}
+
+//count solutions up to 'limit', filling every cell with a single candidate, then branching on the cell with fewest
+//gen is left as it was found
+static uint32_t generate_count(struct generate_struct *gen, uint32_t limit)
+{
+	uint8_t placed[CELLS];		//values of the singles filled here, their cells sit just past the empty list, last first
+	cell_t singles=0;
+	values_t possible, best_possible=0;
+	cell_t index, best=0, cell;
+	uint8_t count, best_count=SIZE+1;
+	uint8_t value;
+	uint8_t progress=TRUE;
+	uint8_t dead=FALSE;
+	uint32_t found=0;
+
+	while(progress && !dead)
+	{
+		progress = FALSE;
+		best_count = SIZE+1;
+		index=0;
+		while(!dead && (index != gen->empties))
+		{
+			cell = gen->empty[index];
+			possible = ALL_VALUES & ~GENERATE_USED(gen, cell);
+			if(!possible)
+				dead = TRUE;
+			else if(!(possible & (possible-1)))		//single
+			{
+				value = LOWEST(possible);
+				GENERATE_PLACE(gen, cell, value);
+				placed[singles++] = value;
+				gen->empties--;
+				gen->empty[index] = gen->empty[gen->empties];
+				gen->empty[gen->empties] = cell;
+				progress = TRUE;
+			}
+			else
+			{
+				//a pair is as good as it gets, past the first one no count is needed
+				if(best_count == 2)
+					count = 3;
+				else if(!((possible & (possible-1)) & ((possible & (possible-1))-1)))
+					count = 2;
+				else
+					count = POPCOUNT(possible);
+				if(count < best_count)
+				{
+					best = index;
+					best_count = count;
+					best_possible = possible;
+				};
+				index++;
+			};
+		};
+	};
+
+	if(!dead && !gen->empties)
+		found = 1;
+	else if(!dead)
+	{
+		//take the cell out of the list while it is filled
+		cell = gen->empty[best];
+		gen->empties--;
+		gen->empty[best] = gen->empty[gen->empties];
+		gen->empty[gen->empties] = cell;
+
+		while(best_possible && (found < limit))
+		{
+			value = LOWEST(best_possible);
+			best_possible &= best_possible-1;
+			GENERATE_PLACE(gen, cell, value);
+			found += generate_count(gen, limit - found);
+			GENERATE_PLACE(gen, cell, value);
+		};
+
+		gen->empty[gen->empties] = gen->empty[best];
+		gen->empty[best] = cell;
+		gen->empties++;
+	};
+
+	//take the singles out again
+	while(singles)
+	{
+		singles--;
+		GENERATE_PLACE(gen, gen->empty[gen->empties], placed[singles]);
+		gen->empties++;
+	};
+
+	return found;
+}
+
+//splitmix64, any seed will do
+static uint64_t rng_next(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//0 to n-1
+static uint32_t rng_below(uint64_t *state, uint32_t n)
+{
+	return (uint32_t)(((rng_next(state) >> 32) * n) >> 32);
+}
+
+//*******************************************************
+// Canonical forms and the solution cache
+//*******************************************************
+
+//put the givens in canonical form, the grid with the fewest leading givens (across then down) over every equivalent
+//transformation, then of those the smallest with digits numbered in order of first appearance
+//canon->best_* say how the form was reached
+//returns FALSE if it was given up on, which only happens to puzzles so symmetric that too many transformations tie
+static uint8_t canon_map(const struct sudoku_ctx *ctx, struct canon_struct *canon)
+{
+	struct canon_order order;
+	uint8_t labels, value, index;
+	cell_t cell;
+
+	canon->columns[0] = 0;
+	canon->columns[1] = 0;
+	cell=0;
+	while(cell != CELLS)
+	{
+		value = ctx->map[cell].certain;
+		canon->grid[0][CELL_Y(cell)][CELL_X(cell)] = value;
+		canon->grid[1][CELL_X(cell)][CELL_Y(cell)] = value;
+		if(value)
+		{
+			canon->columns[0] |= BIT(CELL_X(cell));
+			canon->columns[1] |= BIT(CELL_Y(cell));
+		};
+		cell++;
+	};
+	canon->rows = 0;
+	canon->work = 0;
+
+	//every stack, and every column within a stack, ties to begin with
+	index=0;
+	while(index != BOX)
+	{
+		order.stack[index] = index;
+		value=0;
+		while(value != BOX)
+		{
+			order.column[index][value] = index*BOX + value;
+			value++;
+		};
+		order.column_ties[index] = (uint8_t)((1U << BOX) - 2);
+		index++;
+	};
+	order.stack_ties = (uint8_t)((1U << BOX) - 2);
+
+	canon->transpose=0;
+	while((canon->transpose != 2) && (canon->work < CANON_WORK))
+	{
+		canon->used = 0;
+		canon_rows(canon, 0, &order, FALSE);
+		canon->transpose++;
+	};
+
+	if(canon->work >= CANON_WORK)
+		return FALSE;
+
+	//values not given take the digits left, in order
+	labels=0;
+	value=1;
+	while(value != SIZE+1)
+	{
+		if(canon->best_label[value] > labels)
+			labels = canon->best_label[value];
+		value++;
+	};
+	value=1;
+	while(value != SIZE+1)
+	{
+		if(!canon->best_label[value])
+			canon->best_label[value] = ++labels;
+		value++;
+	};
+
+	return TRUE;
+}
+
+//place rows from 'level' on, with the columns in each order 'order' leaves, following only the rows that keep the givens
+//fewest to the left, ties are each followed, 'improved' if this path is already below form[]
+static void canon_rows(struct canon_struct *canon, uint8_t level, const struct canon_order *order, uint8_t improved)
+{
+	struct canon_order next[SIZE];		//order as each candidate row leaves it
+	uint32_t pattern[SIZE];
+	uint8_t candidate[SIZE];
+	uint8_t count=0, least=0, index, row, take;
+
+	if(level == SIZE)
+	{
+		canon_leaf(canon, order, improved);
+		return;
+	};
+
+	//any row of a band not yet started, then the rest of that band
+	row=0;
+	while(row != SIZE)
+	{
+		if(level % BOX)
+			take = (row / BOX == canon->row[level-1] / BOX) && !(canon->used & BIT(row));
+		else
+			take = !(canon->used & (((1U << BOX) - 1) << (row - row % BOX)));
+		if(take)
+			candidate[count++] = row;
+		row++;
+	};
+
+	index=0;
+	while(index != count)
+	{
+		next[index] = *order;
+		pattern[index] = canon_refine(canon, &next[index], candidate[index]);
+		if(pattern[index] < pattern[least])
+			least = index;
+		index++;
+	};
+	canon->work += count;
+
+	if((level >= canon->rows) || (pattern[least] < canon->pattern[level]))
+	{
+		canon->pattern[level] = pattern[least];
+		canon->rows = level+1;
+		improved = TRUE;
+	}
+	else if(pattern[least] > canon->pattern[level])
+		return;
+
+	index=0;
+	while((index != count) && (canon->work < CANON_WORK))
+	{
+		if(pattern[index] == pattern[least])
+		{
+			canon->row[level] = candidate[index];
+			canon->used |= BIT(candidate[index]);
+			canon_rows(canon, level+1, &next[index], improved);
+			canon->used &= ~BIT(candidate[index]);
+			improved = FALSE;	//form[] is now this paths best
+		};
+		index++;
+	};
+}
+
+//order the columns for 'row' as far as 'order' lets them move, the empty columns of each group first,
+//then the stacks of each group by their givens, splitting groups that no longer tie
+//returns the givens of the row, a bit per column with the first highest, the smallest the row can have
+static uint32_t canon_refine(const struct canon_struct *canon, struct canon_order *order, uint8_t row)
+{
+	const uint8_t *givens = canon->grid[canon->transpose][row];
+	uint8_t pattern[BOX];
+	uint8_t sorted[BOX];
+	uint8_t stack, start, end, index, empty, moved;
+	uint32_t mask=0;
+
+	stack=0;
+	while(stack != BOX)
+	{
+		start=0;
+		while(start != BOX)
+		{
+			end = canon_group(order->column_ties[stack], start);
+			empty=start;
+			index=start;
+			while(index != end)
+			{
+				if(!givens[order->column[stack][index]])
+					sorted[empty++] = order->column[stack][index];
+				index++;
+			};
+			moved=empty;
+			index=start;
+			while(index != end)
+			{
+				if(givens[order->column[stack][index]])
+					sorted[moved++] = order->column[stack][index];
+				index++;
+			};
+			memcpy(&order->column[stack][start], &sorted[start], end-start);
+			if((empty != start) && (empty != end))
+				order->column_ties[stack] &= ~BIT(empty);
+			start = end;
+		};
+
+		pattern[stack]=0;
+		index=0;
+		while(index != BOX)
+		{
+			pattern[stack] = (uint8_t)((pattern[stack] << 1) | (givens[order->column[stack][index]] != 0));
+			index++;
+		};
+		stack++;
+	};
+
+	//insertion sort, stacks that tie keep their order
+	start=0;
+	while(start != BOX)
+	{
+		end = canon_group(order->stack_ties, start);
+		index = start+1;
+		while(index < end)
+		{
+			stack = order->stack[index];
+			moved = index;
+			while((moved != start) && (pattern[order->stack[moved-1]] > pattern[stack]))
+			{
+				order->stack[moved] = order->stack[moved-1];
+				moved--;
+			};
+			order->stack[moved] = stack;
+			index++;
+		};
+		index = start+1;
+		while(index < end)
+		{
+			if(pattern[order->stack[index]] != pattern[order->stack[index-1]])
+				order->stack_ties &= ~BIT(index);
+			index++;
+		};
+		start = end;
+	};
+
+	index=0;
+	while(index != BOX)
+	{
+		mask = (mask << BOX) | pattern[order->stack[index]];
+		index++;
+	};
+
+	return mask;
+}
+
+//end of the group of stacks or columns starting at 'start', those tied to it
+static uint8_t canon_group(uint8_t ties, uint8_t start)
+{
+	uint8_t end = start+1;
+
+	while((end != BOX) && (ties & BIT(end)))
+		end++;
+
+	return end;
+}
+
+//every row placed, stacks and columns still tied have the same givens throughout so only the digits can order them
+//try each order of those groups, except those with no givens at all
+static void canon_leaf(struct canon_struct *canon, const struct canon_order *order, uint8_t improved)
+{
+	uint8_t stack, start, end;
+
+	canon->order = *order;
+	canon->improved = improved;
+	canon->groups = 0;
+
+	start=0;
+	while(start != BOX)
+	{
+		end = canon_group(order->stack_ties, start);
+		stack = order->stack[start];
+		if((end - start > 1) && ((canon->columns[canon->transpose] >> (stack*BOX)) & ((1U << BOX) - 1)))
+		{
+			canon->group[canon->groups] = &canon->order.stack[start];
+			canon->group_size[canon->groups++] = end - start;
+		};
+		start = end;
+	};
+
+	stack=0;
+	while(stack != BOX)
+	{
+		start=0;
+		while(start != BOX)
+		{
+			end = canon_group(order->column_ties[stack], start);
+			if((end - start > 1) && (canon->columns[canon->transpose] & BIT(order->column[stack][start])))
+			{
+				canon->group[canon->groups] = &canon->order.column[stack][start];
+				canon->group_size[canon->groups++] = end - start;
+			};
+			start = end;
+		};
+		stack++;
+	};
+
+	canon_swap(canon, 0, 0);
+}
+
+//each order of the tied group 'group' from 'index' on, and of the groups after it
+static void canon_swap(struct canon_struct *canon, uint8_t group, uint8_t index)
+{
+	uint8_t *items;
+	uint8_t other, swap;
+
+	if(group == canon->groups)
+	{
+		canon_form(canon);
+		return;
+	};
+	if(index == canon->group_size[group]-1)
+	{
+		canon_swap(canon, group+1, 0);
+		return;
+	};
+
+	items = canon->group[group];
+	other=index;
+	while((other != canon->group_size[group]) && (canon->work < CANON_WORK))
+	{
+		swap = items[index];
+		items[index] = items[other];
+		items[other] = swap;
+		canon_swap(canon, group, index+1);
+		items[other] = items[index];
+		items[index] = swap;
+		other++;
+	};
+}
+
+//the grid in the row and column order being tried, digits numbered as they appear, kept if it is below form[]
+static void canon_form(struct canon_struct *canon)
+{
+	const struct canon_order *order = &canon->order;
+	const uint8_t *givens;
+	uint8_t label[SIZE+1];
+	uint8_t labels=1, level, place, index, value;
+	cell_t cell=0;
+
+	canon->work++;
+	memset(label, 0, sizeof(label));
+	level=0;
+	while(level != SIZE)
+	{
+		givens = canon->grid[canon->transpose][canon->row[level]];
+		place=0;
+		while(place != BOX)
+		{
+			index=0;
+			while(index != BOX)
+			{
+				value = givens[order->column[order->stack[place]][index]];
+				if(value && !label[value])
+					label[value] = labels++;
+				if(!canon->improved)
+				{
+					if(label[value] > canon->form[cell])
+						return;
+					canon->improved = (label[value] < canon->form[cell]);
+				};
+				canon->form[cell++] = label[value];
+				index++;
+			};
+			place++;
+		};
+		level++;
+	};
+
+	if(canon->improved)
+	{
+		canon->best_transpose = canon->transpose;
+		memcpy(canon->best_row, canon->row, SIZE);
+		place=0;
+		while(place != BOX)
+		{
+			memcpy(&canon->best_column[place*BOX], order->column[order->stack[place]], BOX);
+			place++;
+		};
+		memcpy(canon->best_label, label, SIZE+1);
+		canon->improved = FALSE;
+	};
+}
+
+//cell of the puzzle at 'cell' of its canonical form
+static cell_t canon_cell(const struct canon_struct *canon, cell_t cell)
+{
+	uint8_t row = canon->best_row[cell / SIZE];
+	uint8_t column = canon->best_column[cell % SIZE];
+
+	return canon->best_transpose ? rcs_cell[ROW][column][row] : rcs_cell[ROW][row][column];
+}
+
+//an empty cache, NULL if out of memory
+static struct cache_struct* cache_new(void)
+{
+	struct cache_struct *cache = malloc(sizeof(struct cache_struct));
+
+	if(cache)
+	{
+		cache->entry = calloc(CACHE_SLOTS, sizeof(struct cache_entry));
+		if(!cache->entry)
+		{
+			free(cache);
+			return NULL;
+		};
+		cache->size = CACHE_SLOTS;
+		cache->count = 0;
+		cache->added = 0;
+		cache->rejected = 0;
+		pthread_mutex_init(&cache->lock, NULL);
+	};
+
+	return cache;
+}
+
+static void cache_free(struct cache_struct *cache)
+{
+	pthread_mutex_destroy(&cache->lock);
+	free(cache->entry);
+	free(cache);
+}
+
+//answer a puzzle from the cache, writing the solution as a line in the puzzles own places and values (not null terminated)
+//returns FALSE if its form is not held
+static uint8_t cache_find(struct cache_struct *cache, const struct canon_struct *canon, char *line)
+{
+	struct cache_entry *entry;
+	uint8_t solution[CELLS];
+	uint8_t value[SIZE+1];
+	uint64_t hash = cache_hash(canon->form);
+	uint8_t found;
+	cell_t cell;
+
+	pthread_mutex_lock(&cache->lock);
+	entry = cache_slot(cache, canon->form, hash);
+	found = (entry->hash != 0);
+	if(found)
+		memcpy(solution, entry->solution, CELLS);
+	pthread_mutex_unlock(&cache->lock);
+
+	if(found)
+	{
+		value[0] = 0;
+		cell=1;
+		while(cell != SIZE+1)
+		{
+			value[canon->best_label[cell]] = (uint8_t)cell;
+			cell++;
+		};
+		cell=0;
+		while(cell != CELLS)
+		{
+			line[canon_cell(canon, cell)] = solution[cell] ? VALUE_CHAR(value[solution[cell]]) : '.';
+			cell++;
+		};
+	};
+
+	return found;
+}
+
+//hold the solution in ctx under the puzzles canonical form
+static void cache_add(struct cache_struct *cache, const struct canon_struct *canon, const struct sudoku_ctx *ctx)
+{
+	uint8_t solution[CELLS];
+	cell_t cell=0;
+
+	while(cell != CELLS)
+	{
+		solution[cell] = canon->best_label[ctx->map[canon_cell(canon, cell)].certain];
+		cell++;
+	};
+
+	pthread_mutex_lock(&cache->lock);
+	cache_put(cache, canon->form, solution);
+	pthread_mutex_unlock(&cache->lock);
+}
+
+//hold a form and its solution, unless the form is already held (call with the lock held, or before workers start)
+//the cache stops growing if memory runs out, forms that do not fit are not held
+static void cache_put(struct cache_struct *cache, const uint8_t *form, const uint8_t *solution)
+{
+	struct cache_entry *entry;
+	uint64_t hash = cache_hash(form);
+
+	if(((uint64_t)(cache->count+1) * 4 > (uint64_t)cache->size * 3) && !cache_grow(cache))
+		return;
+
+	entry = cache_slot(cache, form, hash);
+	if(!entry->hash)
+	{
+		entry->hash = hash;
+		memcpy(entry->form, form, CELLS);
+		memcpy(entry->solution, solution, CELLS);
+		cache->count++;
+		cache->added++;
+	};
+}
+
+//double the slots, returns FALSE if out of memory
+static uint8_t cache_grow(struct cache_struct *cache)
+{
+	struct cache_entry *old = cache->entry;
+	uint32_t index, size = cache->size;
+
+	if(size > UINT32_MAX/2)
+		return FALSE;
+	cache->entry = calloc((size_t)size*2, sizeof(struct cache_entry));
+	if(!cache->entry)
+	{
+		cache->entry = old;
+		return FALSE;
+	};
+	cache->size = size*2;
+
+	index=0;
+	while(index != size)
+	{
+		if(old[index].hash)
+			*cache_slot(cache, old[index].form, old[index].hash) = old[index];
+		index++;
+	};
+	free(old);
+
+	return TRUE;
+}
+
+//the slot holding 'form', or the free slot it would go in
+static struct cache_entry* cache_slot(struct cache_struct *cache, const uint8_t *form, uint64_t hash)
+{
+	uint32_t index = (uint32_t)hash & (cache->size-1);
+
+	while(cache->entry[index].hash && ((cache->entry[index].hash != hash) || memcmp(cache->entry[index].form, form, CELLS)))
+		index = (index+1) & (cache->size-1);
+
+	return &cache->entry[index];
+}
+
+//FNV-1a of a form, never 0 so 0 can mark a free slot
+static uint64_t cache_hash(const uint8_t *form)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	cell_t cell=0;
+
+	while(cell != CELLS)
+	{
+		hash = (hash ^ form[cell]) * 0x100000001B3ULL;
+		cell++;
+	};
+
+	return hash | 1;
+}
+
+//read "form solution" lines, as written by cache_save(), lines that are not are skipped
+//a solution that is not a valid grid holding its form is skipped and counted in cache->rejected
+//a missing file is an empty cache, returns FALSE if the file is there but can not be read
+static uint8_t cache_load(struct cache_struct *cache, const char *filename)
+{
+	FILE *fp = fopen(filename, "r");
+	char line[CELLS*2+3];
+	uint8_t form[CELLS], solution[CELLS];
+	uint8_t success=TRUE;
+
+	if(!fp)
+		return (access(filename, F_OK) != 0);
+
+	while(fgets(line, sizeof(line), fp))
+	{
+		if((strlen(line) >= CELLS*2+1) && (line[CELLS] == ' ') && cache_parse(line, form) && cache_parse(&line[CELLS+1], solution))
+		{
+			if(cache_check(form, solution))
+				cache_put(cache, form, solution);
+			else
+				cache->rejected++;
+		};
+	};
+	success = !ferror(fp);
+	fclose(fp);
+	cache->added = 0;
+
+	return success;
+}
+
+//write every form held and its solution, a "form solution" line each
+//returns FALSE if the file could not be written
+static uint8_t cache_save(const struct cache_struct *cache, const char *filename)
+{
+	FILE *fp = fopen(filename, "w");
+	const struct cache_entry *entry;
+	char line[CELLS*2+2];
+	uint32_t index=0;
+	uint8_t success;
+	cell_t cell;
+
+	if(!fp)
+		return FALSE;
+
+	while(index != cache->size)
+	{
+		entry = &cache->entry[index];
+		if(entry->hash)
+		{
+			cell=0;
+			while(cell != CELLS)
+			{
+				line[cell] = entry->form[cell] ? VALUE_CHAR(entry->form[cell]) : '.';
+				line[CELLS+1+cell] = entry->solution[cell] ? VALUE_CHAR(entry->solution[cell]) : '.';
+				cell++;
+			};
+			line[CELLS] = ' ';
+			line[CELLS*2+1] = '\n';
+			fwrite(line, 1, sizeof(line), fp);
+		};
+		index++;
+	};
+
+	success = !ferror(fp);
+	if(fclose(fp))
+		success=FALSE;
+
+	return success;
+}
+
+//CELLS cell characters to digits, returns FALSE if any is not a cell
+static uint8_t cache_parse(const char *text, uint8_t *digits)
+{
+	cell_t cell=0;
+
+	while(cell != CELLS)
+	{
+		digits[cell] = char_value(text[cell]);
+		if(digits[cell] == NOT_CELL)
+			return FALSE;
+		cell++;
+	};
+
+	return TRUE;
+}
+
+//TRUE if solution is a full grid, each value once in every row, column and square, agreeing with the givens of form
+static uint8_t cache_check(const uint8_t *form, const uint8_t *solution)
+{
+	values_t seen;
+	uint8_t type, n, i;
+	cell_t cell=0;
+
+	while(cell != CELLS)
+	{
+		if(!solution[cell] || (solution[cell] > SIZE) || (form[cell] && (form[cell] != solution[cell])))
+			return FALSE;
+		cell++;
+	};
+
+	type=0;
+	while(type != 3)
+	{
+		n=0;
+		while(n != SIZE)
+		{
+			seen=0;
+			i=0;
+			while(i != SIZE)
+			{
+				seen |= BIT(solution[rcs_cell[type][n][i]]);
+				i++;
+			};
+			if(seen != ALL_VALUES)
+				return FALSE;
+			n++;
+		};
+		type++;
+	};
+
+	return TRUE;
+}
+
+//*******************************************************
+// Counters
+//*******************************************************
+
+#ifdef SUSOLVE_COUNTERS
+
+static void counters_add(struct counters_struct *total, const struct counters_struct *add)
+{
+	uint64_t *to = (uint64_t*)total;
+	const uint64_t *from = (const uint64_t*)add;
+	uint8_t index=0;
+
+	while(index != COUNTERS)
+	{
+		to[index] += from[index];
+		index++;
+	};
+}
+
+//one "name value" line per counter to stderr
+static void counters_write(const struct counters_struct *counters)
+{
+	uint8_t index;
+
+	index=0;
+	while(index != METHODS)
+	{
+		fprintf(stderr, "%s.runs %llu\r\n", method_string[index], (unsigned long long)counters->method_runs[index]);
+		fprintf(stderr, "%s.hits %llu\r\n", method_string[index], (unsigned long long)counters->method_hits[index]);
+		index++;
+	};
+	index=0;
+	while(index != 4)
+	{
+		fprintf(stderr, "pointing.%s.runs %llu\r\n", pointing_string[index], (unsigned long long)counters->pointing_runs[index]);
+		fprintf(stderr, "pointing.%s.hits %llu\r\n", pointing_string[index], (unsigned long long)counters->pointing_hits[index]);
+		index++;
+	};
+	fprintf(stderr, "naked_set.sets_tested %llu\r\n", (unsigned long long)counters->naked_sets);
+	fprintf(stderr, "hidden_set.sets_tested %llu\r\n", (unsigned long long)counters->hidden_sets);
+	fprintf(stderr, "fish.sets_tested %llu\r\n", (unsigned long long)counters->fish_sets);
+	fprintf(stderr, "chain.starts %llu\r\n", (unsigned long long)counters->chain_starts);
+	fprintf(stderr, "remove_from.calls %llu\r\n", (unsigned long long)counters->remove_calls);
+	fprintf(stderr, "remove_from.empty %llu\r\n", (unsigned long long)counters->remove_empty);
+	fprintf(stderr, "cell_solve.calls %llu\r\n", (unsigned long long)counters->cells_solved);
+	fprintf(stderr, "cell_remove.candidates %llu\r\n", (unsigned long long)counters->candidates_removed);
+}
+
+#endif
+
+//*******************************************************
+// Step log
+//*******************************************************
+
+//record a step, growing the log as needed
+//nothing is printed here, so logging costs a few stores per step
+static void step_add(struct step_log *log, uint8_t kind, cell_t cell, values_t values, uint8_t type_a, places_t rcs_a, uint8_t type_b, places_t rcs_b)
+{
+	struct step_struct *step;
+	uint32_t size;
+
+	if(log->count == log->size)
+	{
+		size = log->size ? log->size*2 : STEP_LOG;
+		step = realloc(log->step, size * sizeof(struct step_struct));
+		if(!step)
+		{
+			log->lost++;
+			return;
+		};
+		log->step = step;
+		log->size = size;
+	};
+
+	step = &log->step[log->count++];
+	step->kind = kind;
+	step->cell = cell;
+	step->values = values;
+	step->type_a = type_a;
+	step->rcs_a = rcs_a;
+	step->type_b = type_b;
+	step->rcs_b = rcs_b;
+	step->cell_b = CELLS;
+	step->cell_c = CELLS;
+	step->first_elim = log->pending;
+	step->elims = (uint16_t)(log->elims - log->pending);
+	log->pending = log->elims;
+}
+
+//a step naming cells, for the chain methods, rule as their step kind describes
+static void step_cells(struct step_log *log, uint8_t kind, values_t values, uint8_t rule, cell_t cell, cell_t cell_b, cell_t cell_c)
+{
+	uint32_t count = log->count;
+
+	step_add(log, kind, cell, values, rule, 0, 0, 0);
+	if(log->count != count)		//not lost
+	{
+		log->step[count].cell_b = cell_b;
+		log->step[count].cell_c = cell_c;
+	};
+}
+
+//record a candidate removed by the step about to be added
+static void step_elim(struct step_log *log, cell_t cell, uint8_t value)
+{
+	struct step_elim *elim;
+	uint32_t size;
+
+	if(log->elims == log->elim_size)
+	{
+		size = log->elim_size ? log->elim_size*2 : STEP_ELIMS;
+		elim = realloc(log->elim, size * sizeof(struct step_elim));
+		if(!elim)
+		{
+			log->lost++;
+			return;
+		};
+		log->elim = elim;
+		log->elim_size = size;
+	};
+
+	log->elim[log->elims].cell = cell;
+	log->elim[log->elims].value = value;
+	log->elims++;
+}
+
+//format every step in the log, then empty it
+static void step_write(struct step_log *log, FILE *fp)
+{
+	uint32_t index=0;
+
+	while(index != log->count)
+	{
+		step_format(fp, &log->step[index]);
+		index++;
+	};
+	if(log->lost)
+		fprintf(fp, "(%lu steps not recorded, out of memory)\r\n", (unsigned long)log->lost);
+	log->count = 0;
+	log->elims = 0;
+	log->pending = 0;
+	log->lost = 0;
+}
+
+//one line per step, values as they are written in the grid
+static void step_format(FILE *fp, const struct step_struct *step)
+{
+	values_t values = step->values;
+
+	switch(step->kind)
+	{
+		case STEP_SOLVE:
+			fprintf(fp, "Solve %c at %i,%i\r\n", VALUE_CHAR(LOWEST(values)), CELL_X(step->cell)+1, CELL_Y(step->cell)+1);
+			break;
+
+		case STEP_SOLE:
+			fprintf(fp, "Sole candidate %c at %i,%i\r\n", VALUE_CHAR(LOWEST(values)), CELL_X(step->cell)+1, CELL_Y(step->cell)+1);
+			break;
+
+		case STEP_UNIQUE:
+			fprintf(fp, "Unique candidate %c found in %s at %i,%i\r\n", VALUE_CHAR(LOWEST(values)), type_string[step->type_a], CELL_X(step->cell)+1, CELL_Y(step->cell)+1);
+			break;
+
+		case STEP_POINTING:
+			fprintf(fp, "Removing %c from %s %i due to pointing from %s %i\r\n", VALUE_CHAR(LOWEST(values)), type_string[step->type_b], LOWEST(step->rcs_b)+1, type_string[step->type_a], LOWEST(step->rcs_a)+1);
+			break;
+
+		case STEP_NAKED:
+			fprintf(fp, "Removing candidates ");
+			while(values)
+			{
+				fprintf(fp, "%c, ", VALUE_CHAR(LOWEST(values)));
+				values &= values-1;
+			};
+			fprintf(fp, "from %s %i due to naked set\r\n", type_string[step->type_a], LOWEST(step->rcs_a)+1);
+			break;
+
+		case STEP_HIDDEN:
+			fprintf(fp, "Hidden set ");
+			while(values)
+			{
+				fprintf(fp, "%c ", VALUE_CHAR(HIGHEST(values)));
+				values &= ~BIT(HIGHEST(values));
+			};
+			fprintf(fp, "in %s %i\r\n", type_string[step->type_a], LOWEST(step->rcs_a)+1);
+			break;
+
+		case STEP_FISH:
+			fprintf(fp, "Removing %c from %s%s ", VALUE_CHAR(LOWEST(values)), type_string[step->type_b], POPCOUNT(step->rcs_b) > 1 ? "s" : "");
+			step_lines(fp, step->rcs_b);
+			fprintf(fp, " due to %s%s on %ss ", (step->cell != CELLS) ? "finned " : "", fish_string[POPCOUNT(step->rcs_a)], type_string[step->type_a]);
+			step_lines(fp, step->rcs_a);
+			if(step->cell != CELLS)
+				fprintf(fp, ", fin at %i,%i", CELL_X(step->cell)+1, CELL_Y(step->cell)+1);
+			fprintf(fp, "\r\n");
+			break;
+
+		case STEP_XYWING:
+			fprintf(fp, "Removing %c from cells seeing %i,%i and %i,%i due to xy-wing with pivot at %i,%i\r\n", VALUE_CHAR(LOWEST(values)),
+				CELL_X(step->cell_b)+1, CELL_Y(step->cell_b)+1, CELL_X(step->cell_c)+1, CELL_Y(step->cell_c)+1, CELL_X(step->cell)+1, CELL_Y(step->cell)+1);
+			break;
+
+		case STEP_COLORING:
+			if(step->type_a == COLOR_WRAP)
+				fprintf(fp, "Removing %c from the colour of %i,%i due to simple coloring, it shares a house with %i,%i of the same colour\r\n", VALUE_CHAR(LOWEST(values)),
+					CELL_X(step->cell)+1, CELL_Y(step->cell)+1, CELL_X(step->cell_b)+1, CELL_Y(step->cell_b)+1);
+			else
+				fprintf(fp, "Removing %c from cells seeing both colours due to simple coloring, such as %i,%i and %i,%i\r\n", VALUE_CHAR(LOWEST(values)),
+					CELL_X(step->cell)+1, CELL_Y(step->cell)+1, CELL_X(step->cell_b)+1, CELL_Y(step->cell_b)+1);
+			break;
+
+		case STEP_CHAIN:
+			fprintf(fp, "Removing %c from cells seeing %i,%i and %i,%i due to %s between them\r\n", VALUE_CHAR(LOWEST(values)),
+				CELL_X(step->cell)+1, CELL_Y(step->cell)+1, CELL_X(step->cell_b)+1, CELL_Y(step->cell_b)+1,
+				(step->type_a == CHAIN_X) ? "an x-chain" : "an alternating inference chain");
+			break;
+	};
+}
+
+//"1, 4 and 7" for each n in rcs
+static void step_lines(FILE *fp, places_t rcs)
+{
+	while(rcs)
+	{
+		fprintf(fp, "%i", LOWEST(rcs)+1);
+		rcs &= rcs-1;
+		if(rcs)
+			fprintf(fp, (rcs & (rcs-1)) ? ", " : " and ");
+	};
+}
+
+//*******************************************************
+// Step trace, for tools rather than people, see susolve.h for the formats
+//*******************************************************
+
+//write the deductions in the log, then a record ending the puzzle, and empty the log
+//cells solved are implied by the deduction before them (or were given), so are left out
+static void trace_write(struct step_log *log, FILE *fp, uint8_t format, uint64_t puzzle, const struct sudoku_ctx *ctx, uint8_t result)
+{
+	static const char* result_string[3] = {"solved", "unsolved", "error"};
+	uint8_t end[8+CELLS];
+	uint32_t index=0, number=0;
+	uint32_t nodes;
+	char grid[CELLS];
+
+#if SUSOLVE_BOX != 3
+	format = TRACE_JSON;	//binary records have byte cells and 16 bit masks
+#endif
+
+	while(index != log->count)
+	{
+		if(log->step[index].kind != STEP_SOLVE)
+		{
+			if(format == TRACE_JSON)
+				trace_json(fp, log, &log->step[index], puzzle, number);
+			else
+				trace_binary(fp, log, &log->step[index]);
+			number++;
+		};
+		index++;
+	};
+
+	write_line_map(ctx, grid);
+	if(format == TRACE_JSON)
+	{
+		fprintf(fp, "{\"puzzle\":%llu,\"result\":\"%s\",\"steps\":%lu,\"search_nodes\":%lu,\"lost\":%lu,\"grid\":\"%.*s\"}\n",
+			(unsigned long long)puzzle, result_string[result], (unsigned long)number, (unsigned long)ctx->search_nodes, (unsigned long)log->lost, CELLS, grid);
+	}
+	else
+	{
+		nodes = (ctx->search_nodes > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)ctx->search_nodes;
+		number = (number > 0xFFFF) ? 0xFFFF : number;
+		end[0] = TRACE_END;
+		end[1] = result;
+		end[2] = (uint8_t)number;
+		end[3] = (uint8_t)(number >> 8);
+		end[4] = (uint8_t)nodes;
+		end[5] = (uint8_t)(nodes >> 8);
+		end[6] = (uint8_t)(nodes >> 16);
+		end[7] = (uint8_t)(nodes >> 24);
+		index=0;
+		while(index != CELLS)
+		{
+			end[8+index] = (uint8_t)(grid[index] == '.' ? 0 : grid[index]-'0');
+			index++;
+		};
+		fwrite(end, 1, sizeof(end), fp);
+	};
+
+	log->count = 0;
+	log->elims = 0;
+	log->pending = 0;
+	log->lost = 0;
+}
+
+//one JSON object per line
+static void trace_json(FILE *fp, const struct step_log *log, const struct step_struct *step, uint64_t puzzle, uint32_t number)
+{
+	const struct step_elim *elim = &log->elim[step->first_elim];
+	values_t values = step->values;
+	uint16_t index;
+
+	fprintf(fp, "{\"puzzle\":%llu,\"step\":%lu,\"technique\":\"%s\",\"id\":%i,\"digits\":[",
+		(unsigned long long)puzzle, (unsigned long)number, method_string[step->kind], step->kind);
+	while(values)
+	{
+		fprintf(fp, (values & (values-1)) ? "%i," : "%i", LOWEST(values));
+		values &= values-1;
+	};
+	fprintf(fp, "]");
+
+	if((step->kind == STEP_SOLE) || (step->kind == STEP_UNIQUE))
+		fprintf(fp, ",\"cell\":%i", step->cell);
+	if((step->kind == STEP_FISH) && (step->cell != CELLS))
+		fprintf(fp, ",\"fin\":%i", step->cell);
+	if(STEP_LINKED(step->kind))
+	{
+		fprintf(fp, ",\"cells\":[%i,%i", step->cell, step->cell_b);
+		if(step->cell_c != CELLS)
+			fprintf(fp, ",%i", step->cell_c);
+		fprintf(fp, "]");
+	};
+	if(step->kind == STEP_COLORING)
+		fprintf(fp, ",\"rule\":\"%s\"", color_string[step->type_a]);
+	if(step->kind == STEP_CHAIN)
+		fprintf(fp, ",\"rule\":\"%s\"", chain_string[step->type_a]);
+	if((step->kind != STEP_SOLE) && !STEP_LINKED(step->kind))
+		trace_houses(fp, "houses", step->type_a, step->rcs_a);
+	if((step->kind == STEP_POINTING) || (step->kind == STEP_FISH))
+		trace_houses(fp, "targets", step->type_b, step->rcs_b);
+
+	if(step->elims)
+	{
+		fprintf(fp, ",\"eliminations\":[");
+		index=0;
+		while(index != step->elims)
+		{
+			fprintf(fp, (index+1 != step->elims) ? "[%i,%i]," : "[%i,%i]", elim[index].cell, elim[index].value);
+			index++;
+		};
+		fprintf(fp, "]");
+	};
+	fprintf(fp, "}\n");
+}
+
+//"name":[["row",n],...] for every n in rcs
+static void trace_houses(FILE *fp, const char *name, uint8_t type, places_t rcs)
+{
+	fprintf(fp, ",\"%s\":[", name);
+	while(rcs)
+	{
+		fprintf(fp, (rcs & (rcs-1)) ? "[\"%s\",%i]," : "[\"%s\",%i]", type_string[type], LOWEST(rcs));
+		rcs &= rcs-1;
+	};
+	fprintf(fp, "]");
+}
+
+//a 12 byte record, then 2 bytes per elimination
+static void trace_binary(FILE *fp, const struct step_log *log, const struct step_struct *step)
+{
+	const struct step_elim *elim = &log->elim[step->first_elim];
+	uint8_t record[12];
+	uint8_t pair[2];
+	uint16_t index;
+	uint8_t placed = (step->kind == STEP_SOLE) || (step->kind == STEP_UNIQUE);
+	uint8_t finned = (step->kind == STEP_FISH) && (step->cell != CELLS);
+	uint8_t targets = (step->kind == STEP_POINTING) || (step->kind == STEP_FISH);
+	uint8_t linked = STEP_LINKED(step->kind);
+	uint8_t rule = (step->kind == STEP_COLORING) || (step->kind == STEP_CHAIN);
+	uint16_t houses = linked ? step->cell_b : (uint16_t)step->rcs_a;	//the other cells, in place of houses
+	uint16_t other = linked ? ((step->cell_c != CELLS) ? step->cell_c : 0xFFFF) : (uint16_t)step->rcs_b;
+
+	record[0] = step->kind;
+	record[1] = (placed || finned || linked) ? step->cell : TRACE_NONE_ID;
+	record[2] = (uint8_t)step->values;
+	record[3] = (uint8_t)(step->values >> 8);
+	record[4] = ((step->kind != STEP_SOLE) && (!linked || rule)) ? step->type_a : TRACE_NONE_ID;
+	record[5] = targets ? step->type_b : TRACE_NONE_ID;
+	record[6] = (uint8_t)houses;
+	record[7] = (uint8_t)(houses >> 8);
+	record[8] = (uint8_t)other;
+	record[9] = (uint8_t)(other >> 8);
+	record[10] = (uint8_t)step->elims;
+	record[11] = (uint8_t)(step->elims >> 8);
+	fwrite(record, 1, sizeof(record), fp);
+
+	index=0;
+	while(index != step->elims)
+	{
+		pair[0] = elim[index].cell;
+		pair[1] = elim[index].value;
+		fwrite(pair, 1, 2, fp);
+		index++;
+	};
+}
+
+//*******************************************************
+// Lanes, LANES puzzles at once
+//*******************************************************
+
+#ifdef LANES
+
+//read a job into the next lane, or answer it straight away if it is not a valid puzzle
+//returns the number of lanes now used
+static uint8_t lanes_load(struct batch_worker *worker, uint32_t job)
+{
+	struct sudoku_ctx *ctx = &worker->ctx;
+	struct lanes_struct *lanes = &worker->lanes;
+	uint8_t cell, lane;
+
+	init_map(ctx);
+	if(!read_range_map(ctx, worker->pool->jobs[job].text, worker->pool->jobs[job].text + worker->pool->jobs[job].length))
+	{
+		batch_solve(worker, &worker->pool->jobs[job]);
+		return lanes->used;
+	};
+
+	lane = lanes->used++;
+	lanes->job[lane] = job;
+	cell=0;
+	while(cell != 81)
+	{
+		lanes->possible[cell][lane] = ctx->map[cell].certain ? 0 : ctx->map[cell].possible;
+		lanes->certain[cell][lane] = ctx->map[cell].certain ? BIT(ctx->map[cell].certain) : 0;
+		cell++;
+	};
+
+	return lanes->used;
+}
+
+//propagate every lane together, then answer each puzzle
+//lanes that stalled carry on from where they got to, lanes that failed start again one at a time
+static void lanes_solve(struct batch_worker *worker)
+{
+	struct lanes_struct *lanes = &worker->lanes;
+	struct batch_job *job;
+	uint8_t cell, lane, solved;
+	uint16_t certain;
+
+	//unused lanes are left empty, they fail and are ignored
+	lane = lanes->used;
+	while(lane != LANES)
+	{
+		cell=0;
+		while(cell != 81)
+		{
+			lanes->possible[cell][lane] = 0;
+			lanes->certain[cell][lane] = 0;
+			cell++;
+		};
+		lane++;
+	};
+
+	lanes_propagate(lanes);
+
+	lane=0;
+	while(lane != lanes->used)
+	{
+		job = &worker->pool->jobs[lanes->job[lane]];
+		solved = !lanes->failed[lane];
+		cell=0;
+		while(cell != 81)
+		{
+			certain = lanes->certain[cell][lane];
+			job->out[cell] = certain ? '0' + LOWEST(certain) : '.';
+			solved &= certain != 0;
+			cell++;
+		};
+		job->out[81] = '\n';
+		job->out_length = 82;
+
+		if(!solved && !lanes->failed[lane])
+			lanes_resume(worker, lane);
+		else if(!solved)
+			batch_solve(worker, job);
+		lane++;
+	};
+
+	lanes->used = 0;
+}
+
+//carry on with a stalled lane one puzzle at a time, as explain mode would
+//if its state does not load it is started again from the line
+static void lanes_resume(struct batch_worker *worker, uint8_t lane)
+{
+	struct lanes_struct *lanes = &worker->lanes;
+	struct sudoku_ctx *ctx = &worker->ctx;
+	struct batch_job *job = &worker->pool->jobs[lanes->job[lane]];
+	uint8_t cell;
+	uint16_t certain;
+
+	init_map(ctx);
+	ctx->apply_all = worker->pool->apply_all;
+
+	cell=0;
+	while(cell != 81)
+	{
+		certain = lanes->certain[cell][lane];
+		if(!certain)
+			cell_remove(ctx, cell, ALL_VALUES & ~lanes->possible[cell][lane]);
+		else if(ctx->map[cell].possible & certain)
+			cell_solve(ctx, cell, LOWEST(certain));
+		else
+		{
+			batch_solve(worker, job);
+			return;
+		};
+		cell++;
+	};
+
+	solve_map(ctx, &worker->dlx, MODE_EXPLAIN);
+	write_line_map(ctx, job->out);
+	if(ctx->search_nodes)
+	{
+		worker->searched++;
+		worker->search_nodes += ctx->search_nodes;
+	};
+}
+
+//sole candidate, unique candidate and pointing (both ways) on every lane, until no lane changes
+//each pass works on the candidate masks of all 9 values at once
+LANES_CLONES
+static void lanes_propagate(struct lanes_struct *lanes)
+{
+	lanes_t possible, single, once, twice, placed, unique, hit, changed;
+	lanes_t segment[9][3], remove[9][3];
+	const lanes_t zero = {0};
+	const lanes_t all_values = zero + ALL_VALUES;
+	const uint8_t *cells;
+	uint8_t cell, type, n, i, part, first, other_a, other_b;
+	uint8_t lane, moving=TRUE;
+
+	lanes->failed = zero;
+	while(moving)
+	{
+		changed = zero;
+
+		//sole candidate, a cell left with one value is solved and the value removed from its peers
+		cell=0;
+		while(cell != 81)
+		{
+			possible = lanes->possible[cell];
+			single = possible & (lanes_t)((possible & (possible-1)) == 0);
+			lanes->certain[cell] |= single;
+			lanes->possible[cell] = possible ^ single;
+			changed |= single;
+			i=0;
+			while(i != 20)
+			{
+				lanes->possible[cell_peers[cell][i]] &= ~single;
+				i++;
+			};
+			cell++;
+		};
+
+		cell=0;
+		while(cell != 81)
+		{
+			lanes->failed |= (lanes_t)((lanes->possible[cell] | lanes->certain[cell]) == 0);
+			cell++;
+		};
+
+		//unique candidate, a value possible in one cell of an RCS is solved there
+		type=0;
+		while(type != 3)
+		{
+			n=0;
+			while(n != 9)
+			{
+				cells = rcs_cell[type][n];
+				once = zero;
+				twice = zero;
+				placed = zero;
+				i=0;
+				while(i != 9)
+				{
+					possible = lanes->possible[cells[i]];
+					twice |= once & possible;
+					once |= possible;
+					placed |= lanes->certain[cells[i]];
+					i++;
+				};
+				lanes->failed |= (lanes_t)((once | placed) != all_values);
+
+				unique = once & ~twice;
+				i=0;
+				while(i != 9)
+				{
+					possible = lanes->possible[cells[i]];
+					hit = possible & unique;
+					lanes->failed |= (lanes_t)((hit & (hit-1)) != 0);	//two values need the same cell
+					hit = (lanes_t)(hit != 0);
+					lanes->possible[cells[i]] = possible & (unique | ~hit);
+					changed |= possible ^ lanes->possible[cells[i]];
+					i++;
+				};
+				n++;
+			};
+			type++;
+		};
+
+		//pointing, segments are the 3 cells a row or column shares with a square
+		//values in one segment of a square are removed from the rest of the row or column, and the other way round
+		type=ROW;
+		while(type != SQUARE)
+		{
+			n=0;
+			while(n != 9)
+			{
+				part=0;
+				while(part != 3)
+				{
+					cells = &rcs_cell[type][n][part*3];
+					segment[n][part] = lanes->possible[cells[0]] | lanes->possible[cells[1]] | lanes->possible[cells[2]];
+					remove[n][part] = zero;
+					part++;
+				};
+				n++;
+			};
+
+			n=0;
+			while(n != 9)
+			{
+				first = n - n%3;
+				part=0;
+				while(part != 3)
+				{
+					//other rows or columns of the same band, other segments of the same row or column
+					other_a = first + (n+1)%3;
+					other_b = first + (n+2)%3;
+					possible = segment[n][part] & ~(segment[other_a][part] | segment[other_b][part]);
+					remove[n][(part+1)%3] |= possible;
+					remove[n][(part+2)%3] |= possible;
+
+					possible = segment[n][part] & ~(segment[n][(part+1)%3] | segment[n][(part+2)%3]);
+					remove[other_a][part] |= possible;
+					remove[other_b][part] |= possible;
+					part++;
+				};
+				n++;
+			};
+
+			n=0;
+			while(n != 9)
+			{
+				i=0;
+				while(i != 9)
+				{
+					cell = rcs_cell[type][n][i];
+					changed |= lanes->possible[cell] & remove[n][i/3];
+					lanes->possible[cell] &= ~remove[n][i/3];
+					i++;
+				};
+				n++;
+			};
+			type++;
+		};
+
+		//carry on while any lane that has not failed is still moving
+		changed &= ~lanes->failed;
+		moving = FALSE;
+		lane=0;
+		while(lane != LANES)
+		{
+			if(changed[lane])
+				moving = TRUE;
+			lane++;
+		};
+	};
+}
+
+#endif
+
+//*******************************************************
+// misc functions
+//*******************************************************
+
+//remove candidate mask 'values' from RCS 'n'
+//the values may be another cells possible mask
+//no text is output, returns true if any candidates were removed
+//only acts on cells with bits set in the location mask 'mask'
+static uint8_t remove_from(struct sudoku_ctx *ctx, uint8_t type, uint8_t n, values_t values, places_t mask)
+{
+	uint8_t i, value;
+	places_t hits;
+	uint8_t success=FALSE;
+
+	while(values)
+	{
+		value = LOWEST(values);
+		values &= values-1;
+		hits = ctx->location[type][n][value] & mask;	//cells with candidate to be removed
+		while(hits)
+		{
+			i = LOWEST(hits);
+			hits &= hits-1;
+			cell_remove(ctx, rcs_cell[type][n][i], BIT(value));
+			if(ctx->log)
+				step_elim(ctx->log, rcs_cell[type][n][i], value);
+			success=TRUE;
+		};
+	};
+
+	COUNT(ctx, remove_calls);
+	COUNT_ADD(ctx, remove_empty, !success);
+	return success;
+}
+
+//remove candidate mask 'values' from a single cell, keeping the location masks in step
+//returns the candidates that were actually removed
+static values_t cell_remove(struct sudoku_ctx *ctx, cell_t cell, values_t values)
+{
+	uint8_t value, x, y, sq_n, sq_i;
+	values_t removed;
+	rcs_t rcs;
+	struct cell_struct *cell_ptr = &ctx->map[cell];
+
+	removed = cell_ptr->possible & values;
+	if(!removed)
+		return 0;
+	cell_ptr->possible &= ~removed;
+	COUNT_ADD(ctx, candidates_removed, POPCOUNT(removed));
+
+	x = CELL_X(cell);
+	y = CELL_Y(cell);
+	sq_n = cell_rcs[cell][SQUARE];
+	sq_i = cell_index[cell][SQUARE];
+
+	//mark everything that could now find something new
+	rcs = RCS_BIT(ROW, y) | RCS_BIT(COLUMN, x) | RCS_BIT(SQUARE, sq_n);
+	ctx->dirty_cells[x] |= BIT(y);
+	ctx->dirty_naked |= rcs;
+	ctx->dirty_hidden |= rcs;
+	ctx->dirty_fish[ROW] |= removed;
+	ctx->dirty_fish[COLUMN] |= removed;
+
+	values = removed;
+	while(values)
+	{
+		value = LOWEST(values);
+		values &= values-1;
+		ctx->location[ROW][y][value] &= ~BIT(x);
+		ctx->location[COLUMN][x][value] &= ~BIT(y);
+		ctx->location[SQUARE][sq_n][value] &= ~BIT(sq_i);
+		ctx->dirty_unique[value] |= rcs;
+		ctx->dirty_pointing[0][value] |= rcs;
+		ctx->dirty_pointing[1][value] |= rcs;
+		ctx->dirty_pointing[2][value] |= rcs;
+		ctx->dirty_pointing[3][value] |= rcs;
+	};
+
+	return removed;
+}
+
+static void init_map(struct sudoku_ctx *ctx)
+{
+	uint8_t x,y,z;
+
+	ctx->cells_solved = 0;
+	ctx->search_nodes = 0;
+	memset(ctx->method_steps, 0, sizeof(ctx->method_steps));
+	ctx->apply_all = FALSE;
+	ctx->timing = FALSE;
+	ctx->log = NULL;
+	memset(ctx->solved, 0, sizeof(ctx->solved));
+
+	//nothing has been looked at yet
+	z=0;
+	while(z != SIZE+1)
+	{
+		x=0;
+		while(x != 4)
+		{
+			ctx->dirty_pointing[x][z] = ALL_RCS;
+			x++;
+		};
+		ctx->dirty_unique[z] = ALL_RCS;
+		if(z != SIZE)
+			ctx->dirty_cells[z] = ALL_CELLS;
+		z++;
+	};
+	ctx->dirty_naked = ALL_RCS;
+	ctx->dirty_hidden = ALL_RCS;
+	ctx->dirty_fish[ROW] = ALL_VALUES;
+	ctx->dirty_fish[COLUMN] = ALL_VALUES;
+
+	y=0;
+	while(y != SIZE)
+	{
+		x=0;
+		while(x != SIZE)
+		{
+			map_get(ctx, COLUMN, x,y)->certain = 0;
+			map_get(ctx, COLUMN, x,y)->possible = ALL_VALUES;
+			x++;
+		};
+		y++;
+	};
+
+	//every value possible everywhere
+	y=0;
+	while(y != 3)
+	{
+		x=0;
+		while(x != SIZE)
+		{
+			z = 0;
+			while(z != SIZE+1)
+			{
+				ctx->location[y][x][z] = (z ? ALL_CELLS:0);
+				z++;
+			};
+			x++;
+		};
+		y++;
+	};
+}
+
+// read file, each digit 1-9 represents a solved cell (then A onwards on larger grids, see char_value())
+// unsolved cells are represented by . or 0
+// ignores all other characters, fails if < 81 cells found
+// returns success
+static uint8_t read_file_map(struct sudoku_ctx *ctx, FILE *fp)
+{
+	int tempchar;
+	cell_t index=0;
+	uint8_t success=TRUE;
+
+	//nothing past the last cell is consumed, so a file can hold several puzzles
+	while(success && (index != CELLS))
+	{
+		tempchar = getc(fp);
+		if(tempchar != EOF)
+			success = read_char_map(ctx, (char)tempchar, &index);
+		else
+			success=FALSE;
+	};
+
+	return success;
+}
+
+// as read_file_map, from a null terminated string
+static uint8_t read_string_map(struct sudoku_ctx *ctx, const char *str)
+{
+	return read_range_map(ctx, str, str + strlen(str));
+}
+
+// as read_file_map, from the characters [start, end)
+// characters are classified 16 at a time, then only the cells are visited
+static uint8_t read_range_map(struct sudoku_ctx *ctx, const char *start, const char *end)
+{
+	uint8_t length, value;
+	cell_t index=0;
+	uint8_t success=TRUE;
+	uint32_t cells;
+
+	while(success && (index != CELLS) && (start != end))
+	{
+		length = (end - start < 16) ? (uint8_t)(end - start) : 16;
+		cells = read_classify(start, length);
+		while(success && cells && (index != CELLS))
+		{
+#if SUSOLVE_SIZE < 10
+			value = start[LOWEST(cells)] & 0x0F;	//'.' is 0x2E
+			if(value > SIZE)
+				value = 0;
+#else
+			value = char_value(start[LOWEST(cells)]);
+#endif
+			cells &= cells-1;
+			if(value && (ctx->map[index].possible & BIT(value)))
+				cell_solve(ctx, index, value);
+			else if(value)
+				success=FALSE;
+			index++;
+		};
+		start += length;
+	};
+
+	return success && (index == CELLS);
+}
+
+// bit i set if text[i] is a cell ('.' or '0'-'9'), for up to 16 characters
+static uint32_t read_classify(const char *text, uint8_t length)
+{
+	uint32_t cells=0;
+	uint8_t i;
+
+#if defined(SIMD_X86) && defined(__SSE2__)
+	__m128i chars;
+
+	if(length == 16)
+	{
+		chars = _mm_loadu_si128((const __m128i*)text);
+		chars = _mm_or_si128(
+			_mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0'-1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('9'+1))),
+			_mm_cmpeq_epi8(chars, _mm_set1_epi8('.')));
+		return (uint32_t)_mm_movemask_epi8(chars);
+	};
+#endif
+
+	i=0;
+	while(i != length)
+	{
+		if(char_value(text[i]) != NOT_CELL)
+			cells |= BIT(i);
+		i++;
+	};
+
+	return cells;
+}
+
+// load one character into cell 'index' (0-80 across then down), advancing index if it was a cell
+// returns FALSE if the digit is not possible in that cell
+static uint8_t read_char_map(struct sudoku_ctx *ctx, char tempchar, cell_t *index)
+{
+	uint8_t success=TRUE;
+	uint8_t value = char_value(tempchar);
+
+	//insert digit?
+	if(value && (value != NOT_CELL))
+	{
+		if(ctx->map[*index].possible & BIT(value))	//if value possible
+			cell_solve(ctx, *index, value);			//solve cell
+		else
+			success=FALSE;
+	};
+	//advance to next cell?
+	if(value != NOT_CELL)
+		(*index)++;
+
+	return success;
+}
+
+// value of a cell character, 1-9 then A or a (10) onwards up to SIZE, 0 for '.' or '0'
+// NOT_CELL for anything else, including letters on grids up to 9x9
+static uint8_t char_value(char tempchar)
+{
+	uint8_t value = NOT_CELL;
+
+	if((tempchar == '.') || (tempchar == '0'))
+		value = 0;
+	else if(('1' <= tempchar) && (tempchar <= '9'))
+		value = tempchar - '0';
+	else if(('A' <= tempchar) && (tempchar <= 'Z'))
+		value = tempchar - 'A' + 10;
+	else if(('a' <= tempchar) && (tempchar <= 'z'))
+		value = tempchar - 'a' + 10;
+
+	return ((value == NOT_CELL) || (value <= SIZE)) ? value : NOT_CELL;
+}
+
+// write the map as 81 characters across then down, '.' for unsolved cells (not null terminated)
+static void write_line_map(const struct sudoku_ctx *ctx, char *line)
+{
+	cell_t index=0;
+	uint8_t value;
+
+	while(index != CELLS)
+	{
+		value = ctx->map[index].certain;
+		line[index] = (value ? VALUE_CHAR(value) : '.');
+		index++;
+	};
+}
+
+// write the map as 9 lines of 9 characters, as write_line_map
+static void write_grid_map(const struct sudoku_ctx *ctx)
+{
+	char line[CELLS];
+	uint8_t y=0;
+
+	write_line_map(ctx, line);
+	while(y != SIZE)
+	{
+		printf("%.*s\r\n", SIZE, &line[y*SIZE]);
+		y++;
+	};
+}
+
+static void cell_solve(struct sudoku_ctx *ctx, cell_t cell, uint8_t value)
+{
+	uint8_t index;
+
+	ctx->cells_solved++;
+	COUNT(ctx, cells_solved);
+
+	if(ctx->log)
+		step_add(ctx->log, STEP_SOLVE, cell, BIT(value), 0, 0, 0, 0);
+
+	//solve cell
+	ctx->map[cell].certain = value;
+	ctx->solved[ROW][cell_rcs[cell][ROW]] |= BIT(value);
+	ctx->solved[COLUMN][cell_rcs[cell][COLUMN]] |= BIT(value);
+	ctx->solved[SQUARE][cell_rcs[cell][SQUARE]] |= BIT(value);
+
+	cell_remove(ctx, cell, ALL_VALUES);		//remove all candidates within solved cell
+
+	//remove candidate from row, column and square
+	index=0;
+	while(index != PEERS)
+	{
+		cell_remove(ctx, cell_peers[cell][index], BIT(value));
+		index++;
+	};
+}
+
+static void show_map(struct sudoku_ctx *ctx)
+{
+	uint8_t x, y=0;
+	uint8_t cellx, celly;
+	uint8_t notei;
+
+	printf("\r\n");
+	show_rule(TRUE);
+	while(y!=SIZE*BOX)
+	{
+		x=0;
+		celly = y/BOX;
+		printf("# ");
+		while(x!=SIZE*BOX)
+		{
+			cellx = x/BOX;
+			if(map_get(ctx, COLUMN, cellx,celly)->certain)
+			{
+				if((x%BOX==BOX/2) && (y%BOX==BOX/2))
+					printf("%c", VALUE_CHAR(map_get(ctx, COLUMN, cellx,celly)->certain));
+				else
+					printf(" ");
+			}
+			else
+			{
+				notei = 1 + (x%BOX) + (y%BOX)*BOX;
+				if(map_get(ctx, COLUMN, cellx,celly)->possible & BIT(notei))
+					printf("%c", VALUE_CHAR(notei));
+				else
+					printf(" ");
+			};
+			if(x%BOX == BOX-1)
+			{
+				if(x%SIZE == SIZE-1)
+					printf(" # ");
+				else
+					printf("|");
+			};
+			x++;
+		};
+		printf("\r\n");
+		if(y%BOX == BOX-1)
+			show_rule(y%SIZE == SIZE-1);
+		y++;
+	};
+}
+
+//a line across the board, all '#' below a band of squares, otherwise "# ---+---+--- # ..." below a row of cells
+static void show_rule(uint8_t band)
+{
+	uint8_t x=0;
+
+	if(band)
+	{
+		while(x != 1 + BOX*(SIZE+BOX+2))
+		{
+			printf("#");
+			x++;
+		};
+	}
+	else
+	{
+		printf("#");
+		while(x != SIZE)
+		{
+			printf("%s%.*s", x%BOX ? "+" : " ", BOX, "-----");
+			if(x%BOX == BOX-1)
+				printf(" #");
+			x++;
+		};
+	};
+	printf("\r\n");
+}
+
+//used to generate all combinations of 'size' fingers within 'last_index', fingers[0] the highest
+//returns 1 at the end of the search
+static uint8_t finger_step(uint8_t *fingers, uint8_t size, uint8_t last_index)
+{
+	uint8_t i=0;
+
+	//the lowest finger that can still move up
+	while((i != size) && (fingers[i] == last_index-i))
+		i++;
+	if(i == size)
+		return 1;	//end of search
+
+	//move it, the fingers above follow on from it
+	fingers[i]++;
+	while(i)
+	{
+		i--;
+		fingers[i] = fingers[i+1]+1;
+	};
+
+	return 0;
+}
+
+//***********************************************************************************************
+// Map addressing (row/column/square), map array is otherwise accessed by cell number
+//***********************************************************************************************
+
+//get cell# from row/col/square 'n'
+static struct cell_struct* map_get(struct sudoku_ctx *ctx, uint8_t type, uint8_t n, uint8_t cellno)
+{
+	return &ctx->map[rcs_cell[type][n][cellno]];
+}
+
+#if SUSOLVE_BOX != 3
+
+//fill in the lookup tables, run when the library is loaded (9x9 has them written out)
+static void tables_init(void)
+{
+	cell_t cell, other;
+	uint8_t x, y, sq_n, sq_i, peers;
+
+	cell=0;
+	while(cell != CELLS)
+	{
+		x = cell % SIZE;
+		y = cell / SIZE;
+		sq_n = (y/BOX)*BOX + x/BOX;
+		sq_i = (y%BOX)*BOX + x%BOX;
+		cell_rcs[cell][ROW] = y;
+		cell_rcs[cell][COLUMN] = x;
+		cell_rcs[cell][SQUARE] = sq_n;
+		cell_index[cell][ROW] = x;
+		cell_index[cell][COLUMN] = y;
+		cell_index[cell][SQUARE] = sq_i;
+		rcs_cell[ROW][y][x] = cell;
+		rcs_cell[COLUMN][x][y] = cell;
+		rcs_cell[SQUARE][sq_n][sq_i] = cell;
+		cell++;
+	};
+
+	//peers in cell order, as the 9x9 table has them
+	cell=0;
+	while(cell != CELLS)
+	{
+		peers=0;
+		other=0;
+		while(other != CELLS)
+		{
+			if((other != cell) && ((cell_rcs[other][ROW] == cell_rcs[cell][ROW]) || (cell_rcs[other][COLUMN] == cell_rcs[cell][COLUMN]) || (cell_rcs[other][SQUARE] == cell_rcs[cell][SQUARE])))
+				cell_peers[cell][peers++] = other;
+			other++;
+		};
+		cell++;
+	};
+}
+
+#endif
+
+//*******************************************************
+// Methods
+//*******************************************************
+
+//Sole candidate, if a cell has only one possibility
+static uint8_t sole_candidate(struct sudoku_ctx *ctx)
+{
+	uint8_t x, y;
+	uint8_t value;
+	uint8_t success=FALSE, finished=FALSE;
+	places_t cells;
+	struct cell_struct *cell_ptr;
+
+	x=0;
+	while(x!=SIZE && !finished)
+	{
+		cells = ctx->dirty_cells[x];	//only cells changed since last looked at
+		while(cells && !finished)
+		{
+			y = LOWEST(cells);
+			cells &= cells-1;
+			cell_ptr = map_get(ctx, COLUMN, x, y);
+			if(POPCOUNT(cell_ptr->possible)==1)
+			{
+				value = LOWEST(cell_ptr->possible);
+				if(ctx->log)
+					step_add(ctx->log, STEP_SOLE, rcs_cell[COLUMN][x][y], BIT(value), 0, 0, 0, 0);
+				cell_solve(ctx, rcs_cell[COLUMN][x][y], value);
+				finished = !ctx->apply_all;
+				success=TRUE;
+			}
+			else
+				ctx->dirty_cells[x] &= ~BIT(y);
+		};
+		x++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_SOLE]);
+	COUNT_ADD(ctx, method_hits[METHOD_SOLE], success);
+	return success;
+}
+
+//Unique candidate
+//If a particular number can only be in one place within a row column or square
+static uint8_t unique_candidate(struct sudoku_ctx *ctx)
+{
+	uint8_t value=1, type;
+	uint8_t n, rcs_index;
+	cell_t cell;
+	uint8_t finished=FALSE, success=FALSE;
+	places_t mask;
+	rcs_t rcs;
+
+	while((value !=SIZE+1) && (!finished))
+	{
+		//check for unique candidate, in each n and type changed since last looked at
+		rcs = ctx->dirty_unique[value];
+		while(rcs && !finished)
+		{
+			rcs_index = RCS_LOWEST(rcs);
+			rcs &= rcs-1;
+			n = rcs_index/3;
+			type = rcs_index%3;
+
+			//unique candidate found?
+			mask = ctx->location[type][n][value];
+			if(POPCOUNT(mask)==1)
+			{
+				cell = rcs_cell[type][n][LOWEST(mask)];
+				if(ctx->log)
+					step_add(ctx->log, STEP_UNIQUE, cell, BIT(value), type, BIT(n), 0, 0);
+				cell_solve(ctx, cell, value);
+				finished = !ctx->apply_all;
+				success = TRUE;
+			}
+			else
+				ctx->dirty_unique[value] &= ~RCS_BIT(type, n);
+		};
+
+		value++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_UNIQUE]);
+	COUNT_ADD(ctx, method_hits[METHOD_UNIQUE], success);
+	return success;
+}
+
+//remove from type_b due to pointing in type_a
+static uint8_t pointing(struct sudoku_ctx *ctx, uint8_t type_a, uint8_t type_b)
+{
+	uint8_t	finished=FALSE;
+	uint8_t	success=FALSE;
+	uint8_t	found;
+	uint8_t	value, n, n_b=0, i, count;
+	places_t cells, keep;
+	rcs_t rcs;
+	rcs_t *dirty = ctx->dirty_pointing[POINTING_INDEX(type_a, type_b)];
+
+	value=1;
+	while((value !=SIZE+1) && !finished)
+	{
+		rcs = dirty[value] & RCS_TYPE_BITS(type_a);	//only type_a n changed since last looked at
+		while(rcs && !finished)
+		{
+			n = RCS_LOWEST(rcs)/3;
+			rcs &= rcs-1;
+			found=FALSE;
+			count=0;
+			keep=0;
+			cells = ctx->location[type_a][n][value];
+			while(cells && (count !=2))
+			{
+				i = LOWEST(cells);
+				cells &= cells-1;
+				keep |= BIT(TRANS_TYPE_I(type_b, type_a, n, i));
+				if(!count)
+				{
+					n_b = TRANS_TYPE_N(type_b, type_a, n, i);
+					count=1;
+				}
+				else if(n_b != TRANS_TYPE_N(type_b, type_a, n, i))
+					count=2;
+			};
+			if(count == 1)
+			{
+				if(remove_from(ctx, type_b, n_b, BIT(value), ALL_CELLS & ~keep))
+				{
+					if(ctx->log)
+						step_add(ctx->log, STEP_POINTING, 0, BIT(value), type_a, BIT(n), type_b, BIT(n_b));
+					finished = !ctx->apply_all;
+					success=TRUE;
+					found=TRUE;
+				};
+			};
+			if(!found)
+				dirty[value] &= ~RCS_BIT(type_a, n);
+		};
+		value++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_POINTING]);
+	COUNT_ADD(ctx, method_hits[METHOD_POINTING], success);
+	COUNT(ctx, pointing_runs[POINTING_INDEX(type_a, type_b)]);
+	COUNT_ADD(ctx, pointing_hits[POINTING_INDEX(type_a, type_b)], success);
+	return success;
+}
+
+//naked set
+// if N cells hold between them only N candidates, those candidates may be removed from the rest of the rcs
+// set size is 2-4 (see NAKED_MAX), the cells need not hold the same candidates, eg. 12, 23 and 13 are a naked triple
+static uint8_t naked_set(struct sudoku_ctx *ctx)
+{
+	uint8_t i, n=0;
+	uint8_t set_size;
+	uint8_t index;
+	uint8_t type;
+	uint8_t unsolved, count;
+	uint8_t finished=FALSE, success=FALSE, found;
+	uint8_t place[SIZE+1];		//rcs index of each unsolved cell
+	values_t possible[SIZE+1];	//and its candidates
+	uint8_t member[SIZE+1];		//unsolved cells that may join a set of the current size
+	uint8_t fingers[NAKED_MAX];
+	places_t set_mask;
+	values_t set_values;
+	rcs_t rcs = ctx->dirty_naked;	//only n and type changed since last looked at
+
+	while(rcs && !finished)
+	{
+		index = RCS_LOWEST(rcs);
+		rcs &= rcs-1;
+		n = index/3;
+		type = index%3;
+		found=FALSE;
+
+		//the unsolved cells, access with place[1 - unsolved]
+		unsolved=0;
+		i=0;
+		while(i != SIZE)
+		{
+			set_values = map_get(ctx, type, n, i)->possible;
+			if(set_values)
+			{
+				unsolved++;
+				place[unsolved] = i;
+				possible[unsolved] = set_values;
+			};
+			i++;
+		};
+
+		//a set of every unsolved cell has nothing left to remove
+		set_size=2;
+		while((set_size <= NAKED_MAX) && (set_size < unsolved) && !finished)
+		{
+			//only cells with no more candidates than the set size can be in it, they are indexed by member[1 - count]
+			count=0;
+			i=1;
+			while(i <= unsolved)
+			{
+				if(POPCOUNT(possible[i]) <= set_size)
+					member[++count] = i;
+				i++;
+			};
+
+			if(count >= set_size)
+			{
+				//init fingers
+				index = 0;
+				while(index != set_size)
+				{
+					fingers[index] = set_size-index;
+					index++;
+				};
+
+				do
+				{
+					//union of the cells indexed by fingers, stopping once it outgrows the set
+					COUNT(ctx, naked_sets);
+					set_values=0;
+					set_mask=ALL_CELLS;
+					index=0;
+					while((index != set_size) && (POPCOUNT(set_values) <= set_size))
+					{
+						set_values |= possible[member[fingers[index]]];
+						set_mask &= ~BIT(place[member[fingers[index]]]);
+						index++;
+					};
+					if((index == set_size) && (POPCOUNT(set_values) == set_size))
+					{
+						if(remove_from(ctx, type, n, set_values, set_mask))
+						{
+							if(ctx->log)
+								step_add(ctx->log, STEP_NAKED, 0, set_values, type, BIT(n), 0, 0);
+							finished = !ctx->apply_all;
+							success=TRUE;
+							found=TRUE;
+						};
+					};
+				}while(!finished && !finger_step(fingers, set_size, count));
+			};
+
+			set_size++;
+		};
+		if(!found)
+			ctx->dirty_naked &= ~RCS_BIT(type, n);
+	};
+
+	COUNT(ctx, method_runs[METHOD_NAKED]);
+	COUNT_ADD(ctx, method_hits[METHOD_NAKED], success);
+	return success;
+}
+
+//hidden set
+// if N numbers are limited to N cells, then other candidates in those cells may be removed
+// set size is 2-8 (2-4 on grids past 9x9, see HIDDEN_MAX)
+// if 1,2,3,4,5,6,7,8 only occur in cells a,b,c,d,e,f,g,h, any 9's within a-h can be eliminated
+static uint8_t hidden_set(struct sudoku_ctx *ctx)
+{
+	uint8_t type=0;
+	uint8_t n=0;
+	uint8_t set_size;
+	uint8_t index;
+	uint8_t finished=FALSE, success=FALSE, found;
+	places_t *mask;			// access with mask[value 1-9]
+	uint8_t fingers[HIDDEN_MAX];
+	places_t tempmask;
+	values_t set_values;
+	uint8_t flag;
+	rcs_t rcs;
+	type=0;
+	while((type !=3) && !finished)
+	{
+		rcs = ctx->dirty_hidden & RCS_TYPE_BITS(type);	//only n changed since last looked at
+		while(rcs && !finished)
+		{
+			n = RCS_LOWEST(rcs)/3;
+			rcs &= rcs-1;
+
+			found=FALSE;
+
+			//location masks for each candidate in rcs n
+			mask = ctx->location[type][n];
+
+			set_size=2;
+			while((set_size <= HIDDEN_MAX) && !finished)
+			{
+				//init fingers
+				index = 0;
+				while(index != set_size)
+				{
+					fingers[index] = set_size-index;
+					index++;
+				};
+
+				do
+				{
+				// fingers[0] -> fingers[set_size-1] are values we need to test for hidden set
+				//	tempmask is or'd masks of values indexed by fingers
+					COUNT(ctx, hidden_sets);
+					tempmask=0;
+					set_values=0;
+					index=0;
+					flag=TRUE;
+					while(index != set_size)
+					{
+						tempmask |= mask[fingers[index]];
+						set_values |= BIT(fingers[index]);
+						if(!mask[fingers[index]])
+							flag=FALSE;
+						index++;
+					};
+					//if hidden set found, remove all values bar ones in set
+					if(flag && (POPCOUNT(tempmask) == set_size))
+					{
+						if(remove_from(ctx, type, n, ALL_VALUES & ~set_values, tempmask))
+						{
+							if(ctx->log)
+								step_add(ctx->log, STEP_HIDDEN, 0, set_values, type, BIT(n), 0, 0);
+							finished = !ctx->apply_all;
+							success=TRUE;
+							found=TRUE;
+						};
+					};
+				}while(!finished && !finger_step(fingers, set_size, SIZE));
+
+				set_size++;
+			};
+			if(!found)
+				ctx->dirty_hidden &= ~RCS_BIT(type, n);
+		};
+		type++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_HIDDEN]);
+	COUNT_ADD(ctx, method_hits[METHOD_HIDDEN], success);
+	return success;
+}
+
+//fish, base lines (rows or columns) holding a value only within as many cover lines of the other type
+//eg. if 7 appears in rows 1, 4 and 7 only within columns 2, 5 and 8 (a swordfish), eliminate 7 from the rest of those columns
+//finned, if the base lines also hold the value in fin cells all within one square, eliminate only within that square
+static uint8_t fish(struct sudoku_ctx *ctx)
+{
+	struct fish_struct fish;
+	places_t lines;		//base lines that could be in a fish
+	uint8_t counts[SIZE];	//candidates in each base line
+	uint8_t n, unsolved;
+	uint8_t type=0;
+	uint8_t value;
+	uint8_t finished=FALSE, success=FALSE;
+
+	while((type != 2) && !finished)
+	{
+		value=1;
+		while((value != SIZE+1) && !finished)
+		{
+			if(ctx->dirty_fish[type] & BIT(value))	//only values changed since last looked at
+			{
+				unsolved=0;
+				n=0;
+				while(n != SIZE)
+				{
+					counts[n] = POPCOUNT(ctx->location[type][n][value]);
+					if(counts[n])
+						unsolved++;
+					n++;
+				};
+
+				fish.type = type;
+				if(type == ROW)
+					fish.cover_type = COLUMN;
+				else
+					fish.cover_type = ROW;
+				fish.value = value;
+				fish.found = FALSE;
+				fish.size = 2;
+				while((fish.size <= FISH_MAX) && (fish.size < unsolved) && !finished)	//a fish of every unsolved line removes nothing
+				{
+					//a fish of size n is the other type's fish of unsolved-n, searched for too, so only fins need the larger
+					fish.finned = (fish.size <= FINNED_MAX);
+					if(!fish.finned && (fish.size*2 > unsolved))
+						break;
+					lines=0;
+					n=0;
+					while(n != SIZE)
+					{
+						if((counts[n] > 1) && (counts[n] < (fish.finned ? fish.size+BOX : fish.size+1)))	//singles are left to unique_candidate
+							lines |= BIT(n);
+						n++;
+					};
+					if(POPCOUNT(lines) >= fish.size)
+						finished = fish_lines(ctx, &fish, lines, 0, 0, 0);
+					fish.size++;
+				};
+				if(!finished && !fish.found)	//not cut short by an earlier find
+					ctx->dirty_fish[type] &= ~BIT(value);
+				if(fish.found)
+					success=TRUE;
+			};
+			value++;
+		};
+		type++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_FISH]);
+	COUNT_ADD(ctx, method_hits[METHOD_FISH], success);
+	return success;
+}
+
+//adds each of lines in turn to the base lines, pruning once the cover lines are too many for a fish
+//returns TRUE if a find ends the method
+static uint8_t fish_lines(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t lines, places_t base, places_t cover, uint8_t depth)
+{
+	places_t next;
+	uint8_t n;
+	uint8_t finished=FALSE;
+
+	depth++;
+	while(lines && !finished && (POPCOUNT(lines) >= fish->size - depth + 1))
+	{
+		n = LOWEST(lines);
+		lines &= lines-1;
+		next = cover | ctx->location[fish->type][n][fish->value];
+		COUNT(ctx, fish_sets);
+		if(fish_cover(fish, next))
+		{
+			if(depth == fish->size)
+				finished = fish_found(ctx, fish, base | BIT(n), next);
+			else
+				finished = fish_lines(ctx, fish, lines, base | BIT(n), next, depth);
+		};
+	};
+
+	return finished;
+}
+
+//TRUE if cover could still hold a fish, as many lines as the base, or if finned as many or fewer outside some stack (or band)
+static uint8_t fish_cover(const struct fish_struct *fish, places_t cover)
+{
+	uint8_t stack=0;
+
+	if(POPCOUNT(cover) <= fish->size)
+		return TRUE;
+	if(!fish->finned)
+		return FALSE;
+	while((stack != BOX) && (POPCOUNT(cover & ~BAND_MASK(stack*BOX)) >= fish->size))	//fins all in one stack, with a cover line left there
+		stack++;
+
+	return stack != BOX;
+}
+
+//base lines of fish->size, holding the value within cover
+//a fish if cover is as many lines, otherwise try each stack (or band) for fins, leaving fish->size cover lines
+//returns TRUE if a find ends the method
+static uint8_t fish_found(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t base, places_t cover)
+{
+	places_t inside;	//cover lines through the stack
+	places_t fins;		//cover lines taken as fins
+	places_t fin_lines;	//base lines holding fins
+	places_t lines;
+	places_t band;
+	uint8_t n, stack;
+	uint8_t extra = POPCOUNT(cover) - fish->size;
+	uint8_t finished=FALSE;
+	cell_t fin;
+
+	if(!extra)
+	{
+		if(fish_remove(ctx, fish, cover, ALL_CELLS & ~base))
+		{
+			if(ctx->log)
+				step_add(ctx->log, STEP_FISH, CELLS, BIT(fish->value), fish->type, base, fish->cover_type, cover);
+			finished = !ctx->apply_all;
+		};
+	}
+	else if(POPCOUNT(cover) > fish->size)	//fewer is a contradiction, left for the solve to find
+	{
+		stack=0;
+		while((stack != BOX) && !finished)
+		{
+			inside = cover & BAND_MASK(stack*BOX);
+			if(POPCOUNT(inside) > extra)	//the fins are all here, with a cover line left to eliminate from
+			{
+				fins = inside;
+				while(fins && !finished)
+				{
+					if(POPCOUNT(fins) == extra)
+					{
+						fin_lines=0;
+						lines = fins;
+						while(lines)
+						{
+							n = LOWEST(lines);
+							lines &= lines-1;
+							fin_lines |= ctx->location[fish->cover_type][n][fish->value];
+						};
+						fin_lines &= base;
+						band = BAND_MASK(LOWEST(fin_lines));
+						if(!(fin_lines & ~band) && fish_remove(ctx, fish, inside & ~fins, band & ~base))
+						{
+							if(ctx->log)
+							{
+								n = LOWEST(fin_lines);
+								fin = rcs_cell[fish->type][n][LOWEST(ctx->location[fish->type][n][fish->value] & fins)];
+								step_add(ctx->log, STEP_FISH, fin, BIT(fish->value), fish->type, base, fish->cover_type, inside & ~fins);
+							};
+							finished = !ctx->apply_all;
+						};
+					};
+					fins = (fins-1) & inside;	//next subset of inside
+				};
+			};
+			stack++;
+		};
+	};
+
+	return finished;
+}
+
+//removes the value from the targets cover lines, at the mask positions, marking the fish found
+static uint8_t fish_remove(struct sudoku_ctx *ctx, struct fish_struct *fish, places_t targets, places_t mask)
+{
+	uint8_t success=FALSE;
+	uint8_t n;
+
+	while(targets)
+	{
+		n = LOWEST(targets);
+		targets &= targets-1;
+		if((ctx->location[fish->cover_type][n][fish->value] & mask) && remove_from(ctx, fish->cover_type, n, BIT(fish->value), mask))
+			success=TRUE;
+	};
+	if(success)
+		fish->found=TRUE;
+
+	return success;
+}
+
+//*******************************************************
+// Chains, on the links between candidates
+//*******************************************************
+
+//xy-wing, a bivalue pivot xy sees bivalue pincers xz and yz, whichever the pivot is one pincer is z
+//eg. pivot 12 sees 13 and 23, remove 3 from every cell seeing both pincers
+static uint8_t xy_wing(struct sudoku_ctx *ctx, struct link_graph *links)
+{
+	values_t pivot_values, common, values;
+	cell_t index, pivot, pincer_a, pincer_b;
+	uint8_t i, j, value;
+	uint8_t finished=FALSE, success=FALSE;
+
+	if(!links->built)
+		links_build(ctx, links);
+
+	index=0;
+	while((index != links->bivalues) && !finished)
+	{
+		pivot = links->bivalue[index];
+		pivot_values = ctx->map[pivot].possible;
+		i=0;
+		while((i != PEERS) && (POPCOUNT(pivot_values) == 2) && !finished)
+		{
+			pincer_a = cell_peers[pivot][i];
+			values = ctx->map[pincer_a].possible;
+			common = values & pivot_values;
+			if((POPCOUNT(values) == 2) && (POPCOUNT(common) == 1))
+			{
+				value = LOWEST(values & ~common);	//z
+				values = (pivot_values & ~common) | BIT(value);	//the other pincer
+				j=0;
+				while((j != PEERS) && !finished)
+				{
+					pincer_b = cell_peers[pivot][j];
+					if((ctx->map[pincer_b].possible == values) && links_remove(ctx, pincer_a, pincer_b, value))
+					{
+						if(ctx->log)
+							step_cells(ctx->log, STEP_XYWING, BIT(value), 0, pivot, pincer_a, pincer_b);
+						success=TRUE;
+						finished = !ctx->apply_all;
+					};
+					j++;
+				};
+			};
+			i++;
+		};
+		index++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_XYWING]);
+	COUNT_ADD(ctx, method_hits[METHOD_XYWING], success);
+	return success;
+}
+
+//simple coloring, the conjugates of a value joined into chains, each chain coloured alternately, one colour is true
+//a cell seeing both colours loses the value, and if two cells of one colour see each other that colour loses it
+static uint8_t coloring(struct sudoku_ctx *ctx, struct link_graph *links)
+{
+	cell_t color[CELLS];	//0 not coloured, chain n coloured 2n+2 and 2n+3
+	cell_t cells[CELLS];	//the chain being coloured, doubles as its queue
+	cell_t count, head, cell, other, next_color;
+	uint8_t value, type;
+	uint8_t finished=FALSE, success=FALSE;
+
+	if(!links->built)
+		links_build(ctx, links);
+
+	value=1;
+	while((value != SIZE+1) && !finished)
+	{
+		memset(color, 0, sizeof(color));
+		next_color=2;
+		cell=0;
+		while((cell != CELLS) && !finished)
+		{
+			if((ctx->map[cell].possible & BIT(value)) && !color[cell])
+			{
+				//colour the chain through cell, breadth first
+				color[cell] = next_color;
+				cells[0] = cell;
+				count=1;
+				head=0;
+				while(head != count)
+				{
+					type=0;
+					while(type != 3)
+					{
+						other = links->conjugate[cells[head]][value][type];
+						if((other != CELLS) && !color[other])
+						{
+							color[other] = color[cells[head]] ^ 1;
+							cells[count++] = other;
+						};
+						type++;
+					};
+					head++;
+				};
+				next_color += 2;
+				if((count > 2) && coloring_test(ctx, color, cells, count, value))
+				{
+					success=TRUE;
+					finished = !ctx->apply_all;
+				};
+			};
+			cell++;
+		};
+		value++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_COLORING]);
+	COUNT_ADD(ctx, method_hits[METHOD_COLORING], success);
+	return success;
+}
+
+//the coloring rules for one chain of count cells, returns TRUE if candidates were removed
+static uint8_t coloring_test(struct sudoku_ctx *ctx, const cell_t *color, const cell_t *cells, cell_t count, uint8_t value)
+{
+	cell_t index, cell, first;
+	cell_t other=CELLS;
+	cell_t seen[2];		//a cell of each colour seen
+	cell_t base = color[cells[0]] & ~1;
+	uint8_t i;
+	uint8_t success=FALSE;
+
+	//wrap, a colour seeing itself
+	index=0;
+	while(index != count)
+	{
+		i=0;
+		while((i != PEERS) && (color[cell_peers[cells[index]][i]] != color[cells[index]]))
+			i++;
+		if(i != PEERS)
+		{
+			first = cells[index];
+			other = cell_peers[first][i];
+			index=0;
+			while(index != count)
+			{
+				if((color[cells[index]] == color[first]) && cell_remove(ctx, cells[index], BIT(value)) && ctx->log)
+					step_elim(ctx->log, cells[index], value);
+				index++;
+			};
+			if(ctx->log)
+				step_cells(ctx->log, STEP_COLORING, BIT(value), COLOR_WRAP, first, other, CELLS);
+			return TRUE;
+		};
+		index++;
+	};
+
+	//trap, other cells seeing both colours
+	first = CELLS;
+	cell=0;
+	while(cell != CELLS)
+	{
+		if((ctx->map[cell].possible & BIT(value)) && ((color[cell] & ~1) != base))
+		{
+			seen[0] = CELLS;
+			seen[1] = CELLS;
+			i=0;
+			while(i != PEERS)
+			{
+				other = cell_peers[cell][i];
+				if((color[other] & ~1) == base)
+					seen[color[other] & 1] = other;
+				i++;
+			};
+			if((seen[0] != CELLS) && (seen[1] != CELLS))
+			{
+				cell_remove(ctx, cell, BIT(value));
+				if(ctx->log)
+					step_elim(ctx->log, cell, value);
+				if(first == CELLS)
+				{
+					first = seen[0];
+					other = seen[1];
+				};
+				success=TRUE;
+			};
+		};
+		cell++;
+	};
+	if(success && ctx->log)
+		step_cells(ctx->log, STEP_COLORING, BIT(value), COLOR_TRAP, first, other, CELLS);
+
+	return success;
+}
+
+//chains from each candidate with a strong link, x-chains of one value first as the simpler, then alternating inference chains
+//if the start is false the end is true, so when they hold the same value a cell seeing both loses it
+static uint8_t chain(struct sudoku_ctx *ctx, struct link_graph *links)
+{
+	values_t values;
+	cell_t cell;
+	uint8_t kind, value;
+	uint8_t finished=FALSE, success=FALSE;
+
+	if(!links->built)
+		links_build(ctx, links);
+
+	kind = CHAIN_X;
+	while((kind <= CHAIN_AIC) && !finished)
+	{
+		cell=0;
+		while((cell != CELLS) && !finished)
+		{
+			values = ctx->map[cell].possible;
+			while(values && !finished)
+			{
+				value = LOWEST(values);
+				values &= values-1;
+				if(chain_from(ctx, links, cell, value, kind))
+				{
+					success=TRUE;
+					finished = !ctx->apply_all;
+				};
+			};
+			cell++;
+		};
+		kind++;
+	};
+
+	COUNT(ctx, method_runs[METHOD_CHAIN]);
+	COUNT_ADD(ctx, method_hits[METHOD_CHAIN], success);
+	return success;
+}
+
+//breadth first from value at start taken as off, a strong link from an off candidate turns the other on,
+//a weak link from an on candidate turns the other off, returns TRUE if candidates were removed
+static uint8_t chain_from(struct sudoku_ctx *ctx, struct link_graph *links, cell_t start, uint8_t value, uint8_t kind)
+{
+	struct link_node node, next;
+	values_t values;
+	uint32_t head=0, tail=1;
+	uint8_t i;
+	uint8_t success=FALSE;
+
+	//only worth following from a strong link
+	i=0;
+	while((i != 3) && (links->conjugate[start][value][i] == CELLS))
+		i++;
+	if((i == 3) && ((kind == CHAIN_X) || (POPCOUNT(ctx->map[start].possible) != 2)))
+		return FALSE;
+
+	links->reached[start][value] = BIT(FALSE);
+	links->queue[0].cell = start;
+	links->queue[0].value = value;
+	links->queue[0].on = FALSE;
+	links->queue[0].links = 0;
+	COUNT(ctx, chain_starts);
+
+	while((head != tail) && (!success || ctx->apply_all))
+	{
+		node = links->queue[head++];
+		next.on = !node.on;
+		next.links = node.links + !node.on;
+		if(!node.on)	//strong links, conjugates then the other value of a bivalue cell
+		{
+			i=0;
+			while(i != 4)
+			{
+				next.value = node.value;
+				if(i != 3)
+					next.cell = links->conjugate[node.cell][node.value][i];
+				else if((kind == CHAIN_AIC) && (POPCOUNT(ctx->map[node.cell].possible) == 2) && (ctx->map[node.cell].possible & BIT(node.value)))
+				{
+					next.cell = node.cell;
+					next.value = LOWEST(ctx->map[node.cell].possible & ~BIT(node.value));
+				}
+				else
+					next.cell = CELLS;
+				if((next.cell != CELLS) && !(links->reached[next.cell][next.value] & BIT(TRUE)))
+				{
+					links->reached[next.cell][next.value] |= BIT(TRUE);
+					links->queue[tail++] = next;
+					//start or this is true, the cells between lose the value, each chain is found from both ends
+					if((next.value == value) && (next.cell > start) && links_remove(ctx, start, next.cell, value))
+					{
+						if(ctx->log)
+							step_cells(ctx->log, STEP_CHAIN, BIT(value), kind, start, next.cell, CELLS);
+						success=TRUE;
+					};
+				};
+				i++;
+			};
+		}
+		else if(node.links < CHAIN_MAX)	//weak links, the value in peers then other values in the cell
+		{
+			i=0;
+			while(i != PEERS)
+			{
+				next.cell = cell_peers[node.cell][i];
+				next.value = node.value;
+				if((ctx->map[next.cell].possible & BIT(next.value)) && !(links->reached[next.cell][next.value] & BIT(FALSE)))
+				{
+					links->reached[next.cell][next.value] |= BIT(FALSE);
+					links->queue[tail++] = next;
+				};
+				i++;
+			};
+			values = (kind == CHAIN_AIC) ? ctx->map[node.cell].possible & ~BIT(node.value) : 0;
+			while(values)
+			{
+				next.cell = node.cell;
+				next.value = LOWEST(values);
+				values &= values-1;
+				if(!(links->reached[next.cell][next.value] & BIT(FALSE)))
+				{
+					links->reached[next.cell][next.value] |= BIT(FALSE);
+					links->queue[tail++] = next;
+				};
+			};
+		};
+	};
+
+	//clear what was reached, for the next start
+	head=0;
+	while(head != tail)
+	{
+		links->reached[links->queue[head].cell][links->queue[head].value] = 0;
+		head++;
+	};
+
+	return success;
+}
+
+//conjugates and bivalue cells, from the candidates as they are now
+//candidates are only ever removed, which leaves every link true, so the graph serves the whole solve_step()
+static void links_build(const struct sudoku_ctx *ctx, struct link_graph *links)
+{
+	places_t location, places;
+	cell_t cell, other;
+	uint8_t type, n, value;
+
+	type=0;
+	while(type != 3)
+	{
+		n=0;
+		while(n != SIZE)
+		{
+			value=1;
+			while(value != SIZE+1)
+			{
+				location = ctx->location[type][n][value];
+				places = location;
+				while(places)
+				{
+					cell = rcs_cell[type][n][LOWEST(places)];
+					places &= places-1;
+					if(POPCOUNT(location) == 2)
+						other = rcs_cell[type][n][LOWEST(location & ~BIT(cell_index[cell][type]))];
+					else
+						other = CELLS;
+					links->conjugate[cell][value][type] = other;
+				};
+				value++;
+			};
+			n++;
+		};
+		type++;
+	};
+
+	memset(links->reached, 0, sizeof(links->reached));
+	links->bivalues=0;
+	cell=0;
+	while(cell != CELLS)
+	{
+		if(POPCOUNT(ctx->map[cell].possible) == 2)
+			links->bivalue[links->bivalues++] = cell;
+		cell++;
+	};
+
+	links->built = TRUE;
+}
+
+//removes value from every cell that sees both a and b, returns TRUE if any had it
+static uint8_t links_remove(struct sudoku_ctx *ctx, cell_t a, cell_t b, uint8_t value)
+{
+	cell_t cell;
+	uint8_t i;
+	uint8_t success=FALSE;
+
+	i=0;
+	while(i != PEERS)
+	{
+		cell = cell_peers[a][i];
+		if((cell != b) && (ctx->map[cell].possible & BIT(value)) && cell_sees(cell, b))
+		{
+			cell_remove(ctx, cell, BIT(value));
+			if(ctx->log)
+				step_elim(ctx->log, cell, value);
+			success=TRUE;
+		};
+		i++;
+	};
+
+	return success;
+}
+
+//TRUE if different cells a and b share a row, column or square
+static uint8_t cell_sees(cell_t a, cell_t b)
+{
+	return (a != b) && ((cell_rcs[a][ROW] == cell_rcs[b][ROW]) || (cell_rcs[a][COLUMN] == cell_rcs[b][COLUMN]) || (cell_rcs[a][SQUARE] == cell_rcs[b][SQUARE]));
+}
+
+//*******************************************************
+// Search
+//*******************************************************
+
+//depth first search, used once the solving methods stall
+//fills singles, then branches on the unsolved cell with fewest candidates, trying each on a copy of ctx
+//returns TRUE with the solution in ctx, or FALSE if there is none (ctx is left part solved)
+static uint8_t search(struct sudoku_ctx *ctx)
+{
+	struct sudoku_ctx child;
+	cell_t best;
+	uint8_t value;
+	values_t values;
+	uint8_t success=FALSE;
+	uint8_t apply_all = ctx->apply_all;
+
+	ctx->search_nodes++;
+	COUNT(ctx, method_runs[METHOD_SEARCH]);
+
+	ctx->apply_all = TRUE;
+	while((ctx->cells_solved < CELLS) && (sole_candidate(ctx) || unique_candidate(ctx)));
+	ctx->apply_all = apply_all;
+
+	//contradiction, an unsolved cell with no candidates, or a value with no place left in an RCS
+	if(!scan_cells(ctx->map, &best) || !scan_locations(ctx))
+		return FALSE;
+	if(ctx->cells_solved == CELLS)
+	{
+		COUNT(ctx, method_hits[METHOD_SEARCH]);
+		return TRUE;
+	};
+
+	//branch on the cell with the minimum remaining values
+	values = ctx->map[best].possible;
+	while(values && !success)
+	{
+		value = LOWEST(values);
+		values &= values-1;
+
+		child = *ctx;
+		cell_solve(&child, best, value);
+		success = search(&child);
+		ctx->search_nodes = child.search_nodes;
+#ifdef SUSOLVE_COUNTERS
+		ctx->counters = child.counters;
+#endif
+	};
+
+	if(success)
+		*ctx = child;
+
+	return success;
+}
+
+//*******************************************************
+// Dancing links
+//*******************************************************
+
+//solve by exact cover, the solution is copied into ctx (quietly)
+//nodes searched are left in ctx->search_nodes, returns TRUE if solved
+static uint8_t dlx_solve(struct sudoku_ctx *ctx, struct dlx_struct *dlx)
+{
+	cell_t index, cell;
+	uint8_t value;
+	struct step_log *log;
+
+	if(dlx_count(ctx, dlx, 1))
+	{
+		log = ctx->log;
+		ctx->log = NULL;
+		index=0;
+		while(index != dlx->solution_depth)
+		{
+			cell = dlx->solution[index] / SIZE;
+			value = dlx->solution[index] % SIZE + 1;
+			cell_solve(ctx, cell, value);
+			index++;
+		};
+		ctx->log = log;
+	};
+
+	return (dlx->count != 0);
+}
+
+//count solutions of the unsolved part of the map, up to 'limit', keeping the first in dlx->solution
+//nodes searched are added to ctx->search_nodes
+static uint32_t dlx_count(struct sudoku_ctx *ctx, struct dlx_struct *dlx, uint32_t limit)
+{
+	dlx_build(ctx, dlx);
+	dlx->limit = limit;
+	dlx_search(dlx);
+	ctx->search_nodes += dlx->nodes;
+	COUNT(ctx, method_runs[METHOD_DLX]);
+	COUNT_ADD(ctx, method_hits[METHOD_DLX], dlx->count != 0);
+
+	return dlx->count;
+}
+
+//build the matrix for the unsolved part of the map
+//only constraints not yet met get a column, and only candidates get a row
+static void dlx_build(struct sudoku_ctx *ctx, struct dlx_struct *dlx)
+{
+	cell_t cell;
+	uint8_t x, y, value, i;
+	uint16_t columns[4];
+	values_t possible;
+	uint16_t column, node, prev;
+
+	dlx->depth = 0;
+	dlx->solution_depth = 0;
+	dlx->count = 0;
+	dlx->nodes = 0;
+	dlx->budget = 0;
+
+	//headers, linked in to the root only if still to be met
+	dlx->left[0] = 0;
+	dlx->right[0] = 0;
+	column=1;
+	while(column != DLX_COLUMNS+1)
+	{
+		cell = (column-1) % CELLS;
+		value = cell % SIZE + 1;
+		if(column <= CELLS)
+			i = !ctx->map[cell].certain;
+		else if(column <= CELLS*2)
+			i = !(ctx->solved[ROW][cell/SIZE] & BIT(value));
+		else if(column <= CELLS*3)
+			i = !(ctx->solved[COLUMN][cell/SIZE] & BIT(value));
+		else
+			i = !(ctx->solved[SQUARE][cell/SIZE] & BIT(value));
+
+		dlx->up[column] = column;
+		dlx->down[column] = column;
+		dlx->size[column] = 0;
+		if(i)
+		{
+			dlx->left[column] = dlx->left[0];
+			dlx->right[column] = 0;
+			dlx->right[dlx->left[0]] = column;
+			dlx->left[0] = column;
+		};
+		column++;
+	};
+
+	//a row of 4 nodes for each candidate
+	node = DLX_COLUMNS+1;
+	cell=0;
+	while(cell != CELLS)
+	{
+		x = cell % SIZE;
+		y = cell / SIZE;
+		possible = ctx->map[cell].possible;
+		while(possible)
+		{
+			value = LOWEST(possible);
+			possible &= possible-1;
+
+			columns[0] = 1 + cell;
+			columns[1] = 1 + CELLS + y*SIZE + value-1;
+			columns[2] = 1 + CELLS*2 + x*SIZE + value-1;
+			columns[3] = 1 + CELLS*3 + cell_rcs[cell][SQUARE]*SIZE + value-1;
+
+			i=0;
+			while(i != 4)
+			{
+				column = columns[i];
+				dlx->column[node] = column;
+				dlx->choice[node] = cell*SIZE + value-1;
+
+				//bottom of column
+				prev = dlx->up[column];
+				dlx->up[node] = prev;
+				dlx->down[node] = column;
+				dlx->down[prev] = node;
+				dlx->up[column] = node;
+				dlx->size[column]++;
+
+				//ring of 4 within the row
+				dlx->left[node] = (i ? node-1 : node+3);
+				dlx->right[node] = (i != 3 ? node+1 : node-3);
+				node++;
+				i++;
+			};
+		};
+		cell++;
+	};
+}
+
+//algorithm X, counts solutions up to dlx->limit, keeping the first
+static void dlx_search(struct dlx_struct *dlx)
+{
+	uint16_t column, best, row, node;
+	uint16_t best_size=0xFFFF;
+
+	dlx->nodes++;
+
+	if(dlx->right[0] == 0)
+	{
+		if(!dlx->count)
+		{
+			memcpy(dlx->solution, dlx->partial, dlx->depth*sizeof(uint16_t));
+			dlx->solution_depth = dlx->depth;
+		};
+		dlx->count++;
+		return;
+	};
+
+	//column with fewest rows
+	best = column = dlx->right[0];
+	while(column && best_size)
+	{
+		if(dlx->size[column] < best_size)
+		{
+			best = column;
+			best_size = dlx->size[column];
+		};
+		column = dlx->right[column];
+	};
+	if(!best_size)
+		return;
+
+	dlx_cover(dlx, best);
+	row = dlx->down[best];
+	while((row != best) && (dlx->count < dlx->limit) && (!dlx->budget || (dlx->nodes < dlx->budget)))
+	{
+		dlx->partial[dlx->depth++] = dlx->choice[row];
+		node = dlx->right[row];
+		while(node != row)
+		{
+			dlx_cover(dlx, dlx->column[node]);
+			node = dlx->right[node];
+		};
+
+		dlx_search(dlx);
+
+		node = dlx->left[row];
+		while(node != row)
+		{
+			dlx_uncover(dlx, dlx->column[node]);
+			node = dlx->left[node];
+		};
+		dlx->depth--;
+		row = dlx->down[row];
+	};
+	dlx_uncover(dlx, best);
+}
+
+//remove a column and every row that meets it
+static void dlx_cover(struct dlx_struct *dlx, uint16_t column)
+{
+	uint16_t row, node;
+
+	dlx->right[dlx->left[column]] = dlx->right[column];
+	dlx->left[dlx->right[column]] = dlx->left[column];
+
+	row = dlx->down[column];
+	while(row != column)
+	{
+		node = dlx->right[row];
+		while(node != row)
+		{
+			dlx->down[dlx->up[node]] = dlx->down[node];
+			dlx->up[dlx->down[node]] = dlx->up[node];
+			dlx->size[dlx->column[node]]--;
+			node = dlx->right[node];
+		};
+		row = dlx->down[row];
+	};
+}
+
+//undo dlx_cover, in reverse order
+static void dlx_uncover(struct dlx_struct *dlx, uint16_t column)
+{
+	uint16_t row, node;
+
+	row = dlx->up[column];
+	while(row != column)
+	{
+		node = dlx->left[row];
+		while(node != row)
+		{
+			dlx->size[dlx->column[node]]++;
+			dlx->down[dlx->up[node]] = node;
+			dlx->up[dlx->down[node]] = node;
+			node = dlx->left[node];
+		};
+		row = dlx->up[row];
+	};
+
+	dlx->right[dlx->left[column]] = column;
+	dlx->left[dlx->right[column]] = column;
+}
+
+//*******************************************************
+// Whole map scans
+//*******************************************************
+
+#ifdef SIMD_X86
+//the SSE2 and AVX2 kernels load 4 or 8 cells at a time, one 32 bit lane each
+//possible is the low 16 bits of a lane, certain the next 8, the padding byte is ignored
+	typedef char cell_struct_is_4_bytes[(sizeof(struct cell_struct) == 4) ? 1 : -1];
+#endif
+
+//pick the scans for this processor, run when the library is loaded
+static void simd_init(void)
+{
+	scan_cells = scan_cells_scalar;
+	scan_locations = scan_locations_scalar;
+
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+	{
+		scan_cells = scan_cells_sse2;
+		scan_locations = scan_locations_sse2;
+	};
+	if(__builtin_cpu_supports("avx2"))
+		scan_cells = scan_cells_avx2;
+#endif
+}
+
+//returns FALSE if an unsolved cell has no candidates
+//otherwise best is the unsolved cell with the fewest candidates (lowest cell on a tie), or 81 if all are solved
+static uint8_t scan_cells_scalar(const struct cell_struct *map, cell_t *best)
+{
+	cell_t index;
+	uint8_t count, best_count=SIZE+1;
+
+	*best = CELLS;
+	index=0;
+	while(index != CELLS)
+	{
+		if(!map[index].certain)
+		{
+			count = POPCOUNT(map[index].possible);
+			if(!count)
+				return FALSE;
+			if(count < best_count)
+			{
+				*best = index;
+				best_count = count;
+			};
+		};
+		index++;
+	};
+
+	return TRUE;
+}
+
+//returns FALSE if a value not yet solved in an RCS has no place left in it
+static uint8_t scan_locations_scalar(const struct sudoku_ctx *ctx)
+{
+	uint8_t type, n;
+	values_t missing;
+
+	type=0;
+	while(type != 3)
+	{
+		n=0;
+		while(n != SIZE)
+		{
+			missing = ALL_VALUES & ~ctx->solved[type][n];
+			while(missing)
+			{
+				if(!ctx->location[type][n][LOWEST(missing)])
+					return FALSE;
+				missing &= missing-1;
+			};
+			n++;
+		};
+		type++;
+	};
+
+	return TRUE;
+}
+
+#ifdef SIMD_X86
+
+//each lane gets a key of candidate count << 8 | cell, solved cells get 0x7FFF, so the smallest key is the best cell
+//the top half of each lane is 0x7FFF so 16 bit minimums can be used (SSE2 has no 32 bit minimum)
+__attribute__((target("sse2")))
+static uint8_t scan_cells_sse2(const struct cell_struct *map, cell_t *best)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low16 = _mm_set1_epi32(0x0000FFFF);
+	const __m128i certain_bits = _mm_set1_epi32(0x00FF0000);
+	const __m128i high_keys = _mm_set1_epi32(0x7FFF0000);
+	const __m128i no_key = _mm_set1_epi32(0x00007FFF);
+	const __m128i step = _mm_set1_epi32(4);
+	__m128i cells, possible, unsolved, count, key;
+	__m128i index = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i keys = _mm_set1_epi32(0x7FFF7FFF);
+	__m128i empty = zero;
+	uint16_t best_key;
+	uint8_t cell;
+
+	cell=0;
+	while(cell != 80)
+	{
+		cells = _mm_loadu_si128((const __m128i*)&map[cell]);
+		possible = _mm_and_si128(cells, low16);
+		unsolved = _mm_cmpeq_epi32(_mm_and_si128(cells, certain_bits), zero);
+		empty = _mm_or_si128(empty, _mm_and_si128(unsolved, _mm_cmpeq_epi32(possible, zero)));
+
+		//popcount of the 16 bit candidate mask
+		count = _mm_sub_epi32(possible, _mm_and_si128(_mm_srli_epi32(possible, 1), _mm_set1_epi32(0x5555)));
+		count = _mm_add_epi32(_mm_and_si128(count, _mm_set1_epi32(0x3333)), _mm_and_si128(_mm_srli_epi32(count, 2), _mm_set1_epi32(0x3333)));
+		count = _mm_and_si128(_mm_add_epi32(count, _mm_srli_epi32(count, 4)), _mm_set1_epi32(0x0F0F));
+		count = _mm_and_si128(_mm_add_epi32(count, _mm_srli_epi32(count, 8)), _mm_set1_epi32(0x1F));
+
+		key = _mm_or_si128(_mm_slli_epi32(count, 8), index);
+		key = _mm_or_si128(_mm_and_si128(unsolved, key), _mm_andnot_si128(unsolved, no_key));
+		keys = _mm_min_epi16(keys, _mm_or_si128(key, high_keys));
+
+		index = _mm_add_epi32(index, step);
+		cell += 4;
+	};
+
+	if(_mm_movemask_epi8(empty))
+		return FALSE;
+
+	keys = _mm_min_epi16(keys, _mm_shuffle_epi32(keys, 0x4E));
+	keys = _mm_min_epi16(keys, _mm_shuffle_epi32(keys, 0xB1));
+	best_key = (uint16_t)_mm_cvtsi128_si32(keys);
+
+	//cell 80 is left over
+	if(!map[80].certain)
+	{
+		if(!map[80].possible)
+			return FALSE;
+		if(((uint16_t)POPCOUNT(map[80].possible) << 8 | 80) < best_key)
+			best_key = (uint16_t)POPCOUNT(map[80].possible) << 8 | 80;
+	};
+
+	*best = (best_key == 0x7FFF) ? 81 : (uint8_t)best_key;
+	return TRUE;
+}
+
+//as scan_cells_sse2, 8 cells at a time
+__attribute__((target("avx2")))
+static uint8_t scan_cells_avx2(const struct cell_struct *map, cell_t *best)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low16 = _mm256_set1_epi32(0x0000FFFF);
+	const __m256i certain_bits = _mm256_set1_epi32(0x00FF0000);
+	const __m256i high_keys = _mm256_set1_epi32(0x7FFF0000);
+	const __m256i no_key = _mm256_set1_epi32(0x00007FFF);
+	const __m256i step = _mm256_set1_epi32(8);
+	__m256i cells, possible, unsolved, count, key;
+	__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i keys = _mm256_set1_epi32(0x7FFF7FFF);
+	__m256i empty = zero;
+	__m128i half;
+	uint16_t best_key;
+	uint8_t cell;
+
+	cell=0;
+	while(cell != 80)
+	{
+		cells = _mm256_loadu_si256((const __m256i*)&map[cell]);
+		possible = _mm256_and_si256(cells, low16);
+		unsolved = _mm256_cmpeq_epi32(_mm256_and_si256(cells, certain_bits), zero);
+		empty = _mm256_or_si256(empty, _mm256_and_si256(unsolved, _mm256_cmpeq_epi32(possible, zero)));
+
+		count = _mm256_sub_epi32(possible, _mm256_and_si256(_mm256_srli_epi32(possible, 1), _mm256_set1_epi32(0x5555)));
+		count = _mm256_add_epi32(_mm256_and_si256(count, _mm256_set1_epi32(0x3333)), _mm256_and_si256(_mm256_srli_epi32(count, 2), _mm256_set1_epi32(0x3333)));
+		count = _mm256_and_si256(_mm256_add_epi32(count, _mm256_srli_epi32(count, 4)), _mm256_set1_epi32(0x0F0F));
+		count = _mm256_and_si256(_mm256_add_epi32(count, _mm256_srli_epi32(count, 8)), _mm256_set1_epi32(0x1F));
+
+		key = _mm256_or_si256(_mm256_slli_epi32(count, 8), index);
+		key = _mm256_or_si256(_mm256_and_si256(unsolved, key), _mm256_andnot_si256(unsolved, no_key));
+		keys = _mm256_min_epi16(keys, _mm256_or_si256(key, high_keys));
+
+		index = _mm256_add_epi32(index, step);
+		cell += 8;
+	};
+
+	if(_mm256_movemask_epi8(empty))
+		return FALSE;
+
+	half = _mm_min_epi16(_mm256_castsi256_si128(keys), _mm256_extracti128_si256(keys, 1));
+	half = _mm_min_epi16(half, _mm_shuffle_epi32(half, 0x4E));
+	half = _mm_min_epi16(half, _mm_shuffle_epi32(half, 0xB1));
+	best_key = (uint16_t)_mm_cvtsi128_si32(half);
+
+	if(!map[80].certain)
+	{
+		if(!map[80].possible)
+			return FALSE;
+		if(((uint16_t)POPCOUNT(map[80].possible) << 8 | 80) < best_key)
+			best_key = (uint16_t)POPCOUNT(map[80].possible) << 8 | 80;
+	};
+
+	*best = (best_key == 0x7FFF) ? 81 : (uint8_t)best_key;
+	return TRUE;
+}
+
+//location masks of an RCS are 10 words, values 0-7 and values 2-9 are compared with zero in one pack
+__attribute__((target("sse2")))
+static uint8_t scan_locations_sse2(const struct sudoku_ctx *ctx)
+{
+	const uint16_t *location = &ctx->location[0][0][0];
+	const uint16_t *solved = &ctx->solved[0][0];
+	const __m128i zero = _mm_setzero_si128();
+	__m128i low, high;
+	uint16_t bits, empty;
+	uint8_t rcs;
+
+	rcs=0;
+	while(rcs != 27)
+	{
+		low = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)&location[rcs*10]), zero);
+		high = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)&location[rcs*10+2]), zero);
+		bits = (uint16_t)_mm_movemask_epi8(_mm_packs_epi16(low, high));
+		empty = (bits & 0x00FF) | ((bits >> 8) << 2);
+		if(empty & ALL_VALUES & ~solved[rcs])
+			return FALSE;
+		rcs++;
+	};
+
+	return TRUE;
+}
+
+#endif
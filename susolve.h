@@ -0,0 +1,215 @@
+/*
+
+libsusolve, the solver behind SuSolve, for use in process
+
+	struct susolve *solver = susolve_new();
+	char grid[82];
+
+	susolve_init(solver, 0);
+	if(susolve_load(solver, ".....9.4......75.1.3.5.1.....7...1.29.6.5.3.43.8...6.....3.5.6.5.37......4.2....."))
+	{
+		susolve_solve(solver, SUSOLVE_EXPLAIN);
+		susolve_get_grid(solver, grid);
+	};
+	susolve_free(solver);
+
+A solver holds one puzzle at a time, solvers are independent so each thread can have its own.
+Cells are numbered 0-80 across then down, values are 1-9.
+
+The grid size is fixed when the library is built, by the box order SUSOLVE_BOX, 3 by default for 9x9.
+-DSUSOLVE_BOX=2, 4 or 5 builds for 4x4, 16x16 or 25x25 grids (make builds these as libsusolve4,
+libsusolve16 and libsusolve25), code calling the library must be built with the same value. Past 9x9 the
+functions are renamed with the size by defines below, susolve_new() becomes susolve16_new() and so on,
+so one program can link several sizes, each source file including this with the size it calls.
+Cells are then 0 to SUSOLVE_CELLS-1 and values 1 to SUSOLVE_SIZE, written as 1-9 then A (10) onwards,
+with '.' or '0' for an unsolved cell. Lanes mode and binary traces are 9x9 only, other sizes solve
+lanes batches as explain mode and write JSON traces in place of binary.
+
+Ratings, from susolve_rate() or SuSolve -R, grade a puzzle by the hardest technique the solving methods
+needed, then by how much work they did. The score is 1000 * (hardest technique id + 1) plus the steps
+taken weighted by technique (sole 1, unique 2, pointing 4, naked 8, hidden 12, fish 16, xy_wing 18,
+coloring 20, chain 24, each search node 20), capped at 999. So 1000-1999 needs only sole candidates,
+6000-6999 needs a fish, 9000-9999 a chain, and 10000 and up needs search (technique id 9). The methods
+are applied one deduction per step unless
+SUSOLVE_APPLY_ALL is set, which gives lower scores.
+
+Canonical forms, from susolve_canonical() and behind the batch solution cache (SuSolve -C or -K), are the
+same for every puzzle equivalent to another by relabelling digits, reordering bands, stacks, rows within a
+band or columns within a stack, or transposing. Of all those the form is the grid with its givens as late
+as possible, read across then down, then of those the smallest with digits numbered in order of first
+appearance. A very symmetric puzzle (a full grid, say) can tie so many ways that the form is given up on,
+such puzzles are solved each time. The cache holds a solution for each form solved, so a puzzle with
+several solutions is given whichever one was found for the first puzzle of its form.
+A cache file holds a line per form, the form and its solution in the same digits, separated by a space.
+Lines whose solution is not a valid grid holding its form are dropped when the file is read, with a count on stderr.
+
+Step traces, from susolve_write_trace() or SuSolve -t, list the deductions that solved each puzzle.
+Cells are 0-80, houses are [type, n] with n 0-8, technique ids are 0 sole_candidate, 1 unique_candidate,
+2 pointing, 3 naked_set, 4 hidden_set, 5 fish, 6 xy_wing, 7 coloring, 8 chain. Cells solved by search
+or dancing links are not listed.
+A fish is an xwing, swordfish or jellyfish (2, 3 or 4 base houses), or a finned xwing, whose fin cells
+all in one square limit the eliminations to that square. Coloring is simple coloring of one digit's
+conjugates (its only two places in a house), rule "trap" where a cell sees both colours, or "wrap" where
+a colour sees itself. A chain is an x-chain of one digit's conjugates (rule "x_chain"), or an alternating
+inference chain also through bivalue cells (rule "aic"), between two places of a digit, one of which holds
+it, so cells seeing both lose it.
+
+JSON Lines (SUSOLVE_TRACE_JSON), one object per deduction then one per puzzle:
+	{"puzzle":0,"step":4,"technique":"pointing","id":2,"digits":[7],"houses":[["square",3]],"targets":[["row",4]],"eliminations":[[39,7],[41,7]]}
+	{"puzzle":0,"result":"solved","steps":61,"search_nodes":0,"lost":0,"grid":"81 characters, '.' unsolved"}
+	"cell" is given for the placements (sole and unique candidate), "targets" for pointing and fish (the
+	houses candidates were removed from), "fin" for a finned fish (a fin cell), "cells" in place of houses
+	for xy_wing (pivot then pincers), coloring (a cell of each colour, or for a wrap two of the colour
+	removed) and chain (its ends), "rule" for coloring and chain, "eliminations" lists [cell, digit] for each
+	candidate removed.
+	result is "solved", "unsolved" or "error", lost counts steps dropped for lack of memory.
+
+Binary (SUSOLVE_TRACE_BINARY, 9x9 only), little endian, a 12 byte record per deduction:
+	u8 id, u8 cell, u16 digits (bit per digit), u8 house type, u8 target type, u16 houses (bit per n),
+	u16 targets (bit per n), u16 eliminations, then eliminations * (u8 cell, u8 digit)
+	unused cells and types are 255, types are 0 row, 1 column, 2 square, the cell of a finned fish is a fin
+	xy_wing, coloring and chain give their cells as the cell, then houses and targets (65535 unused), and
+	coloring and chain their rule as the house type (coloring 0 trap, 1 wrap, chain 0 x_chain, 1 aic)
+ending each puzzle with an 89 byte record:
+	u8 255, u8 result (0 solved, 1 unsolved, 2 error), u16 steps, u32 search nodes, 81 * u8 grid (0 unsolved)
+
+Build with make, giving libsusolve.a and libsusolve.so, link with -lsusolve -pthread
+
+*/
+
+#ifndef SUSOLVE_H
+#define SUSOLVE_H
+
+    #include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//*******************************************************
+// Defines
+//*******************************************************
+
+	//grid size, box order 2-5 for 4x4, 9x9, 16x16 or 25x25
+#ifndef SUSOLVE_BOX
+	#define SUSOLVE_BOX		3
+#endif
+	#define SUSOLVE_SIZE	(SUSOLVE_BOX*SUSOLVE_BOX)	//cells in a row, column or square, and values
+	#define SUSOLVE_CELLS	(SUSOLVE_SIZE*SUSOLVE_SIZE)
+
+	//past 9x9 the functions carry the size in their names, so sizes can share a program
+#if SUSOLVE_BOX != 3
+  #if SUSOLVE_BOX == 2
+	#define SUSOLVE_SIZED(name)		susolve4_##name
+  #elif SUSOLVE_BOX == 4
+	#define SUSOLVE_SIZED(name)		susolve16_##name
+  #else
+	#define SUSOLVE_SIZED(name)		susolve25_##name
+  #endif
+	#define susolve_new					SUSOLVE_SIZED(new)
+	#define susolve_free				SUSOLVE_SIZED(free)
+	#define susolve_init				SUSOLVE_SIZED(init)
+	#define susolve_load				SUSOLVE_SIZED(load)
+	#define susolve_load_file			SUSOLVE_SIZED(load_file)
+	#define susolve_step				SUSOLVE_SIZED(step)
+	#define susolve_solve				SUSOLVE_SIZED(solve)
+	#define susolve_count				SUSOLVE_SIZED(count)
+	#define susolve_rate				SUSOLVE_SIZED(rate)
+	#define susolve_generate			SUSOLVE_SIZED(generate)
+	#define susolve_get_cell			SUSOLVE_SIZED(get_cell)
+	#define susolve_get_grid			SUSOLVE_SIZED(get_grid)
+	#define susolve_canonical			SUSOLVE_SIZED(canonical)
+	#define susolve_cells_solved		SUSOLVE_SIZED(cells_solved)
+	#define susolve_search_nodes		SUSOLVE_SIZED(search_nodes)
+	#define susolve_write_steps			SUSOLVE_SIZED(write_steps)
+	#define susolve_write_trace			SUSOLVE_SIZED(write_trace)
+	#define susolve_show				SUSOLVE_SIZED(show)
+	#define susolve_interactive			SUSOLVE_SIZED(interactive)
+	#define susolve_batch				SUSOLVE_SIZED(batch)
+	#define susolve_bench				SUSOLVE_SIZED(bench)
+	#define susolve_generator			SUSOLVE_SIZED(generator)
+	#define susolve_counters_request	SUSOLVE_SIZED(counters_request)
+#endif
+
+	//solving modes
+	#define SUSOLVE_EXPLAIN		0	//solving methods in order of simplicity, then search
+	#define SUSOLVE_FAST		1	//exact cover search with dancing links only
+	#define SUSOLVE_LANES		2	//batches only, 16 puzzles at a time through singles and pointing, then as explain
+
+	//flags for susolve_init()
+	#define SUSOLVE_STEPS		0x01	//record each step taken, see susolve_write_steps()
+	#define SUSOLVE_APPLY_ALL	0x02	//methods apply every deduction they find in one pass, not just the first
+
+	//interactive output levels
+	#define SUSOLVE_OUTPUT_SOLUTION	0	//the solved grid only
+	#define SUSOLVE_OUTPUT_STEPS	1	//each step taken, then the solved grid
+	#define SUSOLVE_OUTPUT_BOARD	2	//the board with candidates before each step, waiting for enter
+
+	//step trace formats
+	#define SUSOLVE_TRACE_NONE		0
+	#define SUSOLVE_TRACE_JSON		1	//JSON Lines
+	#define SUSOLVE_TRACE_BINARY	2	//fixed little endian records
+
+	//a solver, allocated by susolve_new()
+	struct susolve;
+
+	//settings for the front ends, as given on the SuSolve command line
+	struct susolve_options
+	{
+		unsigned char	batch;
+		unsigned char	stats;			//write search statistics to stderr
+		unsigned char	mode;			//SUSOLVE_EXPLAIN, SUSOLVE_FAST or SUSOLVE_LANES
+		unsigned char	apply_all;
+		int				threads;
+		unsigned long	count_limit;	//count solutions up to this instead of solving, 0 to solve
+		unsigned char	bench;
+		unsigned long	repeat;			//benchmark passes over each file
+		unsigned char	output;			//SUSOLVE_OUTPUT_SOLUTION, _STEPS or _BOARD, for one puzzle at a time
+		unsigned char	trace;			//SUSOLVE_TRACE_JSON or _BINARY write a step trace in place of other output
+		unsigned char	rate;			//batch writes a rating per puzzle in place of the solution
+		unsigned long	generate;		//puzzles for the generator to write
+		unsigned long long	seed;			//generator seed, the same seed gives the same puzzles
+		int				target;			//generator writes only puzzles needing this technique id, -1 for any
+		unsigned long	misses;			//generator gives up after this many puzzles in a row miss the target, 0 for 100000
+		unsigned char	cache;			//batch answers puzzles equivalent to one already solved from a cache
+		const char		*cache_file;	//cache kept here between runs, NULL to keep it in memory only
+	};
+
+//*******************************************************
+// Functions
+//*******************************************************
+
+//	one puzzle at a time
+	struct susolve*	susolve_new(void);
+	void			susolve_free(struct susolve *solver);
+	void			susolve_init(struct susolve *solver, unsigned flags);
+	int				susolve_load(struct susolve *solver, const char *grid);
+	int				susolve_load_file(struct susolve *solver, FILE *fp);
+	int				susolve_step(struct susolve *solver);
+	int				susolve_solve(struct susolve *solver, int mode);
+	unsigned long	susolve_count(struct susolve *solver, int mode, unsigned long limit);
+	unsigned long	susolve_rate(struct susolve *solver, int *hardest);
+	void			susolve_generate(struct susolve *solver, unsigned long long *seed, char *grid);
+	int				susolve_get_cell(const struct susolve *solver, int cell);
+	void			susolve_get_grid(const struct susolve *solver, char *grid);
+	int				susolve_canonical(const struct susolve *solver, char *grid);
+	int				susolve_cells_solved(const struct susolve *solver);
+	unsigned long	susolve_search_nodes(const struct susolve *solver);
+	void			susolve_write_steps(struct susolve *solver, FILE *fp);
+	void			susolve_write_trace(struct susolve *solver, FILE *fp, int format, unsigned long long puzzle);
+	void			susolve_show(struct susolve *solver);
+
+//	front ends, each returns a process exit code
+	int				susolve_interactive(const char *filename, const struct susolve_options *options);
+	int				susolve_batch(const char *filename, const struct susolve_options *options);
+	int				susolve_bench(char **filenames, int files, const struct susolve_options *options);
+	int				susolve_generator(const struct susolve_options *options);
+
+//	counters, when built with SUSOLVE_COUNTERS (otherwise does nothing)
+	void			susolve_counters_request(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif